@@ -8,12 +8,197 @@
 #include <regex>
 #include <fstream>
 #include <climits>
+#include <cstring>
 #include <algorithm>
+#include <unordered_map>
+#include <cstdint>
+#include <set>
+#include <tuple>
+#include <array>
+#include <chrono>
+#include <random>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <list>
+#include <filesystem>
+#include <future>
+#include <coroutine>
+#include <source_location>
+#include <exception>
+#include <utility>
+#include <cerrno>
+#include <cmath>
+#include <charconv>
+#include <string_view>
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <malloc.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
 using namespace std;
 
-const string CURRENT_DATE = "2025-05-22";
-const int CURRENT_HOUR = 22;
-const int CURRENT_MINUTE = 19;
+// -------- Clock --------
+// Everything that needs "now" (date validation, log timestamps, prompts, default dates)
+// asks Clock::read(). The default is a fixed clock at 2025-05-22 22:19, the instant the app
+// has always assumed; --clock switches to the system clock or another fixed instant, and
+// the simulator installs a SimulatedClock that it moves forward itself.
+struct ClockReading {
+    string date; // YYYY-MM-DD
+    int hour = 0;
+    int minute = 0;
+
+    string timeText() const {
+        return string(hour < 10 ? "0" : "") + to_string(hour) + ":" + (minute < 10 ? "0" : "") + to_string(minute);
+    }
+};
+
+// Days since 1970-01-01 and back (Howard Hinnant's civil-calendar algorithms).
+int daysFromCivil(int y, int m, int d) {
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+void civilFromDays(int z, int& y, int& m, int& d) {
+    z += 719468;
+    int era = (z >= 0 ? z : z - 146096) / 146097;
+    int doe = z - era * 146097;
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp + (mp < 10 ? 3 : -9);
+    y = yoe + era * 400 + (m <= 2);
+}
+
+string dateFromDays(int days) {
+    int y, m, d;
+    civilFromDays(days, y, m, d);
+    char text[16];
+    snprintf(text, sizeof(text), "%04d-%02d-%02d", y, m, d);
+    return text;
+}
+
+class Clock {
+private:
+    static unique_ptr<Clock> installed;
+
+public:
+    virtual ~Clock() = default;
+    virtual ClockReading now() const = 0;
+
+    static const Clock& current();
+
+    // Not thread-safe: install before any worker or server thread starts.
+    static void install(unique_ptr<Clock> clock) {
+        installed = std::move(clock);
+    }
+
+    static ClockReading read() {
+        return current().now();
+    }
+
+    // Minutes since 1970-01-01 on the installed clock.
+    static int64_t nowMinutes() {
+        ClockReading now = read();
+        int64_t minutes = 0;
+        parseInstant(now.date + " " + now.timeText(), minutes);
+        return minutes;
+    }
+
+    // "YYYY-MM-DD HH:MM" into minutes since 1970-01-01; false if malformed.
+    static bool parseInstant(const string& text, int64_t& minutes) {
+        int y, m, d, hour, minute;
+        char tail;
+        if (sscanf(text.c_str(), "%4d-%2d-%2d %2d:%2d%c", &y, &m, &d, &hour, &minute, &tail) != 5 || m < 1 || m > 12
+            || d < 1 || d > 31 || hour < 0 || hour > 23 || minute < 0 || minute > 59) {
+            return false;
+        }
+        minutes = static_cast<int64_t>(daysFromCivil(y, m, d)) * 1440 + hour * 60 + minute;
+        return true;
+    }
+
+    static ClockReading fromMinutes(int64_t minutes) {
+        int64_t days = minutes >= 0 ? minutes / 1440 : (minutes - 1439) / 1440;
+        int ofDay = static_cast<int>(minutes - days * 1440);
+        return {dateFromDays(static_cast<int>(days)), ofDay / 60, ofDay % 60};
+    }
+};
+
+class FixedClock : public Clock {
+private:
+    ClockReading instant;
+
+public:
+    explicit FixedClock(int64_t minutes) : instant(fromMinutes(minutes)) {}
+
+    ClockReading now() const override {
+        return instant;
+    }
+};
+
+class RealClock : public Clock {
+public:
+    ClockReading now() const override {
+        time_t seconds = time(nullptr);
+        tm local;
+        localtime_r(&seconds, &local);
+        char date[16];
+        strftime(date, sizeof(date), "%Y-%m-%d", &local);
+        return {date, local.tm_hour, local.tm_min};
+    }
+};
+
+// Virtual time, moved only by its owner; safe to read from any thread.
+class SimulatedClock : public Clock {
+private:
+    atomic<int64_t> minutes;
+
+public:
+    explicit SimulatedClock(int64_t start) : minutes(start) {}
+
+    ClockReading now() const override {
+        return fromMinutes(minutes.load(memory_order_relaxed));
+    }
+
+    int64_t minutesNow() const {
+        return minutes.load(memory_order_relaxed);
+    }
+
+    void advanceTo(int64_t target) {
+        minutes.store(max(target, minutes.load(memory_order_relaxed)), memory_order_relaxed);
+    }
+};
+
+const int64_t DEFAULT_CLOCK_MINUTES = static_cast<int64_t>(daysFromCivil(2025, 5, 22)) * 1440 + 22 * 60 + 19;
+unique_ptr<Clock> Clock::installed;
+
+const Clock& Clock::current() {
+    if (!installed) {
+        installed.reset(new FixedClock(DEFAULT_CLOCK_MINUTES));
+    }
+    return *installed;
+}
 
 // -------- Helper Function for Case-Insensitive Handling --------
 string toUpperCase(const string& str) {
@@ -22,6 +207,45 @@ string toUpperCase(const string& str) {
     return upper;
 }
 
+// -------- Buffered Terminal Output --------
+// Menus print a whole screen at a time, so output is collected in one large buffer
+// and written out only when we are about to block on input (or on exit).
+class TerminalWriter {
+private:
+    static const size_t BUFFER_SIZE = 64 * 1024;
+    static char buffer[BUFFER_SIZE];
+    static long flushCount;
+
+public:
+    static void install() {
+        ios::sync_with_stdio(false);
+        cout.rdbuf()->pubsetbuf(buffer, BUFFER_SIZE);
+        // readLine() flushes explicitly, so cin no longer needs to flush cout on every read.
+        cin.tie(nullptr);
+    }
+
+    static void flush() {
+        cout.flush();
+        flushCount++;
+    }
+
+    static long getFlushCount() {
+        return flushCount;
+    }
+
+    static size_t getBufferSize() {
+        return BUFFER_SIZE;
+    }
+};
+
+char TerminalWriter::buffer[TerminalWriter::BUFFER_SIZE];
+long TerminalWriter::flushCount = 0;
+
+bool readLine(string& line) {
+    TerminalWriter::flush();
+    return static_cast<bool>(getline(cin, line));
+}
+
 // -------- Exception Handling --------
 class ReservationException : public exception {
     string message;
@@ -30,6 +254,15 @@ public:
     const char* what() const noexcept override { return message.c_str(); }
 };
 
+// Thrown when the requested table is taken; carries a nearby alternative for the caller.
+class TableUnavailableException : public ReservationException {
+    string suggestion;
+public:
+    TableUnavailableException(const string& suggestion)
+        : ReservationException("Selected table is already booked."), suggestion(suggestion) {}
+    const string& getSuggestion() const { return suggestion; }
+};
+
 // -------- Reservation Struct --------
 struct Reservation {
     string id;
@@ -40,27 +273,71 @@ struct Reservation {
     string time;
     int tableNumber;
 
+    Reservation() : partySize(0), tableNumber(-1) {}
     Reservation(const string& id, const string& name, const string& phone, int size, const string& date, const string& time, int table)
         : id(toUpperCase(id)), customerName(name), phoneNumber(phone), partySize(size), date(date), time(time), tableNumber(table) {}
 };
 
+// -------- Static Tracepoints --------
+// Build with -DENABLE_USDT (needs <sys/sdt.h>, from systemtap-sdt-dev) to compile in USDT
+// probes under the "restaurant" provider, e.g.
+//   bpftrace -l 'usdt:./Finals-Interprog:restaurant:*'
+//   bpftrace -e 'usdt:./Finals-Interprog:restaurant:save_reservations__entry { @start[tid] = nsecs; }
+//                usdt:./Finals-Interprog:restaurant:save_reservations__return { @us = hist((nsecs - @start[tid]) / 1000); }'
+// A probe is a single nop until a tracer attaches. Without ENABLE_USDT the macros expand
+// to nothing at all.
+//
+// USDT_SCOPE(name, ...) fires name__entry with up to two arguments, and name__return when
+// the enclosing scope ends; the return probe's argument is 1 when it is left by an exception.
+#if defined(ENABLE_USDT)
+#include <sys/sdt.h>
+
+#define USDT_ENTRY_0(name) DTRACE_PROBE(restaurant, name##__entry)
+#define USDT_ENTRY_1(name, a) DTRACE_PROBE1(restaurant, name##__entry, a)
+#define USDT_ENTRY_2(name, a, b) DTRACE_PROBE2(restaurant, name##__entry, a, b)
+#define USDT_PICK(_0, _1, _2, macro, ...) macro
+#define USDT_SCOPE(...)                                                                            \
+    USDT_PICK(__VA_ARGS__, USDT_ENTRY_2, USDT_ENTRY_1, USDT_ENTRY_0, _)(__VA_ARGS__);               \
+    USDT_RETURN_GUARD(USDT_FIRST(__VA_ARGS__, _))
+#define USDT_FIRST(name, ...) name
+#define USDT_RETURN_GUARD(name) USDT_RETURN_GUARD_(name)
+#define USDT_RETURN_GUARD_(name)                                                                   \
+    struct UsdtReturn_##name {                                                                     \
+        int exceptionsAtEntry = uncaught_exceptions();                                             \
+        ~UsdtReturn_##name() {                                                                     \
+            int threw = uncaught_exceptions() > exceptionsAtEntry;                                 \
+            DTRACE_PROBE1(restaurant, name##__return, threw);                                      \
+        }                                                                                          \
+    } usdtReturn_##name
+#else
+#define USDT_SCOPE(...) static_cast<void>(0)
+#endif
+
 // -------- Validation Functions --------
 bool validatePhoneNumber(const string& phone) {
+    USDT_SCOPE(validate_phone_number, phone.c_str());
     regex phoneRegex("\\d{3}-\\d{3}-\\d{4}");
     return regex_match(phone, phoneRegex);
 }
 
-bool validateDate(const string& date) {
+// Format and calendar range only; past dates are allowed (used for look-ups).
+bool validateDateFormat(const string& date) {
+    USDT_SCOPE(validate_date_format, date.c_str());
     regex dateRegex("\\d{4}-\\d{2}-\\d{2}");
     if (!regex_match(date, dateRegex)) {
         return false;
     }
     int year, month, day;
     sscanf(date.c_str(), "%d-%d-%d", &year, &month, &day);
-    if (month < 1 || month > 12 || day < 1 || day > 31) {
+    return month >= 1 && month <= 12 && day >= 1 && day <= 31;
+}
+
+bool validateDate(const string& date) {
+    USDT_SCOPE(validate_date, date.c_str());
+    if (!validateDateFormat(date)) {
         return false;
     }
-    string currentDate = CURRENT_DATE;
+    string currentDate = Clock::read().date;
     if (date < currentDate) {
         return false;
     }
@@ -68,6 +345,7 @@ bool validateDate(const string& date) {
 }
 
 bool validateTime(const string& time, const string& date) {
+    USDT_SCOPE(validate_time, time.c_str(), date.c_str());
     regex timeRegex("\\d{2}:\\d{2}");
     if (!regex_match(time, timeRegex)) {
         return false;
@@ -77,8 +355,9 @@ bool validateTime(const string& time, const string& date) {
     if (hour < 0 || hour > 23 || minute < 0 || minute > 59) {
         return false;
     }
-    if (date == CURRENT_DATE) {
-        if (hour < CURRENT_HOUR || (hour == CURRENT_HOUR && minute <= CURRENT_MINUTE)) {
+    ClockReading now = Clock::read();
+    if (date == now.date) {
+        if (hour < now.hour || (hour == now.hour && minute <= now.minute)) {
             return false;
         }
     }
@@ -86,16 +365,19 @@ bool validateTime(const string& time, const string& date) {
 }
 
 bool validatePartySize(int size) {
+    USDT_SCOPE(validate_party_size, size);
     return size >= 1;
 }
 
 bool validateReservationId(const string& id) {
+    USDT_SCOPE(validate_reservation_id, id.c_str());
     string upperId = toUpperCase(id);
     regex idRegex("ID \\d+A");
     return regex_match(upperId, idRegex);
 }
 
 bool validateNumericInput(const string& input, int& result, int minVal, int maxVal) {
+    USDT_SCOPE(validate_numeric_input, input.c_str());
     if (input.empty() || !all_of(input.begin(), input.end(), ::isdigit)) {
         return false;
     }
@@ -114,1240 +396,8418 @@ bool validateNumericInput(const string& input, int& result, int minVal, int maxV
     }
 }
 
-// -------- Singleton Pattern --------
-class ReservationManager {
-private:
-    vector<bool> tables;
-    vector<Reservation> reservations;
-    static unique_ptr<ReservationManager> instance;
-    int nextReservationId;
+// -------- Memory Accounting --------
+// Two views of memory. Every operator new/delete in the process updates the global
+// counters (count, bytes and live bytes as malloc sizes the blocks). Per-subsystem figures
+// come from each structure's memoryBytes(), an estimate of the heap it owns worked out
+// from its container sizes; allocator overhead only shows up in the global numbers.
+struct AllocationCounters {
+    atomic<uint64_t> allocations{0};
+    atomic<uint64_t> frees{0};
+    atomic<uint64_t> bytesAllocated{0};
+    atomic<int64_t> liveBytes{0};
+    atomic<int64_t> peakLiveBytes{0};
+};
+
+AllocationCounters allocationCounters; // constant-initialized, so counting starts before main
 
-    ReservationManager() : tables(10, true), nextReservationId(1) {
-        loadReservations();
+void* operator new(size_t size) {
+    void* block = malloc(size ? size : 1);
+    if (!block) {
+        throw bad_alloc();
     }
+    int64_t usable = static_cast<int64_t>(malloc_usable_size(block));
+    allocationCounters.allocations.fetch_add(1, memory_order_relaxed);
+    allocationCounters.bytesAllocated.fetch_add(usable, memory_order_relaxed);
+    int64_t live = allocationCounters.liveBytes.fetch_add(usable, memory_order_relaxed) + usable;
+    int64_t peak = allocationCounters.peakLiveBytes.load(memory_order_relaxed);
+    while (live > peak && !allocationCounters.peakLiveBytes.compare_exchange_weak(peak, live, memory_order_relaxed)) {
+    }
+    return block;
+}
 
-    string getCurrentTimestamp() {
-        ostringstream oss;
-        oss << CURRENT_DATE << " " << (CURRENT_HOUR < 10 ? "0" : "") << CURRENT_HOUR << ":"
-            << (CURRENT_MINUTE < 10 ? "0" : "") << CURRENT_MINUTE << ":00";
-        return oss.str();
+void operator delete(void* block) noexcept {
+    if (!block) {
+        return;
     }
+    allocationCounters.frees.fetch_add(1, memory_order_relaxed);
+    allocationCounters.liveBytes.fetch_sub(static_cast<int64_t>(malloc_usable_size(block)), memory_order_relaxed);
+    free(block);
+}
 
-    void writeLogToFile(const string& logEntry) {
-        ofstream logFile("logs.txt", ios::app);
-        if (logFile.is_open()) {
-            logFile << logEntry << "\n\n";
-            logFile.close();
-        } else {
-            throw ReservationException("Unable to open log file.");
-        }
+void operator delete(void* block, size_t) noexcept {
+    operator delete(block);
+}
+
+// Heap owned by a value, not counting the value itself. libstdc++ keeps strings of up to
+// 15 characters inline; tree nodes add three pointers and a colour to each element, hash
+// nodes a next pointer and the cached hash.
+const size_t TREE_NODE_OVERHEAD = 32;
+const size_t HASH_NODE_OVERHEAD = 16;
+
+inline size_t heapBytes(const string& text) {
+    return text.capacity() > 15 ? text.capacity() + 1 : 0;
+}
+
+template <class T>
+    requires is_trivially_copyable_v<T>
+size_t heapBytes(const T&) {
+    return 0;
+}
+
+template <class A, class B> size_t heapBytes(const pair<A, B>& item);
+template <class T> size_t heapBytes(const vector<T>& items);
+
+template <class A, class B>
+size_t heapBytes(const pair<A, B>& item) {
+    return heapBytes(item.first) + heapBytes(item.second);
+}
+
+template <class T>
+size_t heapBytes(const vector<T>& items) {
+    size_t bytes = items.capacity() * sizeof(T);
+    for (const auto& item : items) {
+        bytes += heapBytes(item);
     }
+    return bytes;
+}
 
-    void saveReservations() {
-        ofstream resFile("reservations.txt");
-        if (!resFile.is_open()) {
-            throw ReservationException("Unable to open reservations file for writing.");
-        }
-        for (const auto& res : reservations) {
-            resFile << res.id << "|" << res.customerName << "|" << res.phoneNumber << "|"
-                    << res.partySize << "|" << res.date << "|" << res.time << "|"
-                    << res.tableNumber << "\n";
-        }
-        resFile.close();
+template <class T>
+size_t heapBytes(const set<T>& items) {
+    size_t bytes = items.size() * (TREE_NODE_OVERHEAD + sizeof(T));
+    for (const auto& item : items) {
+        bytes += heapBytes(item);
+    }
+    return bytes;
+}
 
-        ofstream idFile("next_id.txt");
-        if (!idFile.is_open()) {
-            throw ReservationException("Unable to open next_id file for writing.");
-        }
-        idFile << nextReservationId << "\n";
-        idFile.close();
+template <class K, class V>
+size_t heapBytes(const unordered_map<K, V>& items) {
+    size_t bytes = items.bucket_count() * sizeof(void*) + items.size() * (HASH_NODE_OVERHEAD + sizeof(pair<const K, V>));
+    for (const auto& item : items) {
+        bytes += heapBytes(item.first) + heapBytes(item.second);
     }
+    return bytes;
+}
 
-    void loadReservations() {
-        ifstream resFile("reservations.txt");
-        if (resFile.is_open()) {
-            string line;
-            while (getline(resFile, line)) {
-                stringstream ss(line);
-                string id, customerName, phoneNumber, date, time;
-                int partySize, tableNumber;
-                getline(ss, id, '|');
-                getline(ss, customerName, '|');
-                getline(ss, phoneNumber, '|');
-                ss >> partySize;
-                ss.ignore(1);
-                getline(ss, date, '|');
-                getline(ss, time, '|');
-                ss >> tableNumber;
+template <class K, class V>
+size_t heapBytes(const map<K, V>& items) {
+    size_t bytes = items.size() * (TREE_NODE_OVERHEAD + sizeof(pair<const K, V>));
+    for (const auto& item : items) {
+        bytes += heapBytes(item.first) + heapBytes(item.second);
+    }
+    return bytes;
+}
 
-                if (tableNumber >= 0 && tableNumber < tables.size()) {
-                    tables[tableNumber] = false;
-                }
+inline size_t heapBytes(const Reservation& res) {
+    return heapBytes(res.id) + heapBytes(res.customerName) + heapBytes(res.phoneNumber) + heapBytes(res.date)
+           + heapBytes(res.time);
+}
 
-                reservations.emplace_back(id, customerName, phoneNumber, partySize, date, time, tableNumber);
+// Subsystems ("store", "indexes", "intern_pool", "log_buffers", "session_table", ...)
+// register named sources; a source reports the bytes it holds and how many items
+// (reservations, names, sessions) those bytes are for, so the report can show a cost
+// per item.
+class MemoryAccounting {
+public:
+    struct Footprint {
+        size_t bytes = 0;
+        size_t items = 0;
+    };
 
-                if (validateReservationId(id)) {
-                    string numStr = id.substr(3, id.length() - 4);
-                    try {
-                        int idNum = stoi(numStr);
-                        nextReservationId = max(nextReservationId, idNum + 1);
-                    } catch (...) {
-                    }
-                }
+private:
+    static mutex sourcesMutex;
+    static map<string, map<string, function<Footprint()>>> sources; // subsystem -> source
+    static chrono::steady_clock::time_point lastReportAt;
+    static uint64_t lastAllocations;
+    static uint64_t lastBytesAllocated;
+
+public:
+    static void registerSource(const string& subsystem, const string& name, function<Footprint()> source) {
+        lock_guard<mutex> lock(sourcesMutex);
+        sources[subsystem][name] = std::move(source);
+    }
+
+    static void unregisterSource(const string& subsystem, const string& name) {
+        lock_guard<mutex> lock(sourcesMutex);
+        auto it = sources.find(subsystem);
+        if (it != sources.end()) {
+            it->second.erase(name);
+            if (it->second.empty()) {
+                sources.erase(it);
             }
-            resFile.close();
         }
+    }
 
-        ifstream idFile("next_id.txt");
-        if (idFile.is_open()) {
-            int savedId;
-            if (idFile >> savedId) {
-                nextReservationId = max(nextReservationId, savedId);
+    // Rates cover the time since the previous report (or since start-up).
+    static void report(ostream& out) {
+        lock_guard<mutex> lock(sourcesMutex);
+        uint64_t allocations = allocationCounters.allocations.load(memory_order_relaxed);
+        uint64_t frees = allocationCounters.frees.load(memory_order_relaxed);
+        uint64_t bytesAllocated = allocationCounters.bytesAllocated.load(memory_order_relaxed);
+        auto now = chrono::steady_clock::now();
+        double seconds = max(1e-6, chrono::duration<double>(now - lastReportAt).count());
+        out << "allocations " << allocations << "\n";
+        out << "frees " << frees << "\n";
+        out << "live_allocations " << allocations - frees << "\n";
+        out << "allocated_bytes_total " << bytesAllocated << "\n";
+        out << "live_bytes " << allocationCounters.liveBytes.load(memory_order_relaxed) << "\n";
+        out << "peak_live_bytes " << allocationCounters.peakLiveBytes.load(memory_order_relaxed) << "\n";
+        out << "allocations_per_sec " << static_cast<uint64_t>((allocations - lastAllocations) / seconds) << "\n";
+        out << "allocated_bytes_per_sec " << static_cast<uint64_t>((bytesAllocated - lastBytesAllocated) / seconds) << "\n";
+        lastReportAt = now;
+        lastAllocations = allocations;
+        lastBytesAllocated = bytesAllocated;
+
+        for (const auto& subsystem : sources) {
+            Footprint total;
+            vector<pair<string, Footprint>> parts;
+            for (const auto& source : subsystem.second) {
+                Footprint part = source.second();
+                total.bytes += part.bytes;
+                total.items += part.items;
+                parts.push_back({source.first, part});
+            }
+            out << subsystem.first << "_bytes " << total.bytes << "\n";
+            out << subsystem.first << "_items " << total.items << "\n";
+            if (total.items > 0) {
+                out << subsystem.first << "_bytes_per_item " << total.bytes / total.items << "\n";
+            }
+            if (parts.size() > 1) {
+                for (const auto& part : parts) {
+                    out << subsystem.first << "." << part.first << "_bytes " << part.second.bytes << "\n";
+                }
             }
-            idFile.close();
         }
     }
+};
 
-public:
-    bool reservationIdExists(const string& id, const string& excludeId = "") {
-        string upperId = toUpperCase(id);
-        string upperExcludeId = toUpperCase(excludeId);
-        for (const auto& res : reservations) {
-            if (res.id == upperId && res.id != upperExcludeId) {
-                return true;
-            }
+mutex MemoryAccounting::sourcesMutex;
+map<string, map<string, function<MemoryAccounting::Footprint()>>> MemoryAccounting::sources;
+chrono::steady_clock::time_point MemoryAccounting::lastReportAt = chrono::steady_clock::now();
+uint64_t MemoryAccounting::lastAllocations = 0;
+uint64_t MemoryAccounting::lastBytesAllocated = 0;
+
+// -------- Phone Number Index --------
+// "123-456-7890" -> 1234567890. Only the digits matter, so any formatting maps to the same key.
+uint64_t normalizePhoneNumber(const string& phone) {
+    uint64_t value = 0;
+    for (char c : phone) {
+        if (isdigit(static_cast<unsigned char>(c))) {
+            value = value * 10 + (c - '0');
         }
-        return false;
     }
+    return value;
+}
 
-    static ReservationManager& getInstance() {
-        if (!instance)
-            instance.reset(new ReservationManager());
-        return *instance;
+// Open-addressing hash map (linear probing) from a normalized phone number to the
+// IDs of every reservation booked under it.
+class PhoneIndex {
+private:
+    enum SlotState : unsigned char { EMPTY, FILLED, DELETED };
+    struct Slot {
+        uint64_t phone = 0;
+        SlotState state = EMPTY;
+        vector<string> ids;
+    };
+    vector<Slot> slots;
+    size_t filled = 0;
+    size_t used = 0; // filled + deleted, drives rehashing
+
+    static size_t hashPhone(uint64_t phone) {
+        phone ^= phone >> 33;
+        phone *= 0xff51afd7ed558ccdULL;
+        phone ^= phone >> 33;
+        phone *= 0xc4ceb9fe1a85ec53ULL;
+        phone ^= phone >> 33;
+        return static_cast<size_t>(phone);
     }
 
-    void logLogin(const string& role, const string& username, const string& password) {
-        string timestamp = getCurrentTimestamp();
-        ostringstream logEntry;
-        logEntry << "Account Log: (" << timestamp << ", N/A) | User: " << username
-                 << " | Password: " << password;
-        writeLogToFile(logEntry.str());
+    size_t findSlot(uint64_t phone) const {
+        size_t mask = slots.size() - 1;
+        for (size_t i = hashPhone(phone) & mask;; i = (i + 1) & mask) {
+            if (slots[i].state == EMPTY || (slots[i].state == FILLED && slots[i].phone == phone)) {
+                return i;
+            }
+        }
     }
 
-    void logReservationAction(const string& role, const string& username, const string& action, const string& details,
-                              const string& id = "", const string& customerName = "", const string& phoneNumber = "",
-                              int partySize = 0, const string& date = "", const string& time = "", int tableNumber = -1) {
-        ostringstream logEntry;
-        logEntry << "Reservation Log\n"
-                 << "Action: " << action << " by " << role << ": " << username << "\n"
-                 << "Details: " << details;
-        if (!id.empty() || !customerName.empty() || !phoneNumber.empty() || partySize > 0 ||
-            !date.empty() || !time.empty() || tableNumber >= 0) {
-            logEntry << "\n"
-                     << "ID: " << (id.empty() ? "N/A" : id) << " | "
-                     << "Name: " << (customerName.empty() ? "N/A" : customerName) << " | "
-                     << "Contact: " << (phoneNumber.empty() ? "N/A" : phoneNumber) << " | "
-                     << "Party-Size: " << (partySize > 0 ? to_string(partySize) : "N/A") << " | "
-                     << "Date: " << (date.empty() ? "N/A" : date) << " | "
-                     << "Time: " << (time.empty() ? "N/A" : time) << " | "
-                     << "Table: " << (tableNumber >= 0 ? to_string(tableNumber + 1) : "N/A");
+    void rehash(size_t newCapacity) {
+        vector<Slot> old;
+        old.swap(slots);
+        slots.resize(newCapacity);
+        filled = used = 0;
+        for (auto& slot : old) {
+            if (slot.state == FILLED) {
+                size_t i = findSlot(slot.phone);
+                slots[i] = std::move(slot);
+                filled++;
+                used++;
+            }
         }
-        writeLogToFile(logEntry.str());
     }
 
-    void logError(const string& role, const string& username, const string& action, const string& errorMsg,
-                  const string& id = "", const string& customerName = "", const string& phoneNumber = "",
-                  int partySize = 0, const string& date = "", const string& time = "", int tableNumber = -1) {
-        ostringstream logEntry;
-        logEntry << "Reservation Error Log\n"
-                 << "Action: " << action << " by " << role << ": " << username << "\n"
-                 << "Error: " << errorMsg;
-        if (!id.empty() || !customerName.empty() || !phoneNumber.empty() || partySize > 0 ||
-            !date.empty() || !time.empty() || tableNumber >= 0) {
-            logEntry << "\n"
-                     << "ID: " << (id.empty() ? "N/A" : id) << " | "
-                     << "Name: " << (customerName.empty() ? "N/A" : customerName) << " | "
-                     << "Contact: " << (phoneNumber.empty() ? "N/A" : phoneNumber) << " | "
-                     << "Party-Size: " << (partySize > 0 ? to_string(partySize) : "N/A") << " | "
-                     << "Date: " << (date.empty() ? "N/A" : date) << " | "
-                     << "Time: " << (time.empty() ? "N/A" : time) << " | "
-                     << "Table: " << (tableNumber >= 0 ? to_string(tableNumber + 1) : "N/A");
+public:
+    PhoneIndex() : slots(16) {}
+
+    void add(const string& phone, const string& id) {
+        if ((used + 1) * 10 > slots.size() * 7) {
+            rehash(filled * 2 >= slots.size() / 2 ? slots.size() * 2 : slots.size());
         }
-        writeLogToFile(logEntry.str());
+        uint64_t key = normalizePhoneNumber(phone);
+        size_t i = findSlot(key);
+        if (slots[i].state == EMPTY) {
+            slots[i].phone = key;
+            slots[i].state = FILLED;
+            filled++;
+            used++;
+        }
+        slots[i].ids.push_back(id);
     }
 
-    void viewTableAvailability() {
-        for (int i = 0; i < tables.size(); ++i) {
-            cout << "Table " << i + 1 << " is " << (tables[i] ? "AVAILABLE" : "BOOKED") << endl;
+    void remove(const string& phone, const string& id) {
+        size_t i = findSlot(normalizePhoneNumber(phone));
+        if (slots[i].state != FILLED) {
+            return;
+        }
+        auto& ids = slots[i].ids;
+        ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+        if (ids.empty()) {
+            slots[i].state = DELETED;
+            filled--;
         }
     }
 
-    bool hasReservations(const string& customerName) {
-        for (const auto& res : reservations) {
-            if (res.customerName == customerName) {
-                return true;
-            }
+    const vector<string>* find(const string& phone) const {
+        size_t i = findSlot(normalizePhoneNumber(phone));
+        return slots[i].state == FILLED ? &slots[i].ids : nullptr;
+    }
+
+    void clear() {
+        slots.assign(16, Slot());
+        filled = used = 0;
+    }
+
+    size_t memoryBytes() const {
+        size_t bytes = slots.capacity() * sizeof(Slot);
+        for (const auto& slot : slots) {
+            bytes += heapBytes(slot.ids);
         }
-        return false;
+        return bytes;
+    }
+};
+
+// -------- Customer Name Search Index --------
+// Each distinct customer name is interned once and inserted into a lowercase trie.
+// Searching walks the trie with one Levenshtein row per node, so a query only visits
+// the branches that can still be within the allowed edit distance.
+class NameSearchIndex {
+public:
+    struct Match {
+        string name;
+        int distance;        // edit distance between the query and the closest prefix of name
+        vector<string> ids;  // reservations booked under this name
+    };
+
+private:
+    struct TrieNode {
+        vector<pair<char, int>> children; // sorted by character
+        vector<int> nameIds;              // names ending here (differing only in case)
+    };
+    vector<string> names;                 // intern pool: name id -> name
+    unordered_map<string, int> nameIds;
+    vector<vector<string>> reservationIds;
+    vector<TrieNode> nodes;
+
+    static char lower(char c) {
+        return static_cast<char>(tolower(static_cast<unsigned char>(c)));
     }
 
-    vector<Reservation> getAllReservations() const {
-        return reservations;
+    int childOf(int node, char c) const {
+        const auto& children = nodes[node].children;
+        auto it = lower_bound(children.begin(), children.end(), make_pair(c, INT_MIN));
+        return (it != children.end() && it->first == c) ? it->second : -1;
     }
 
-    int reserveTable(const string& customerName, const string& phoneNumber,
-                    int partySize, const string& date, const string& time, int tableNumber) {
-        if (!validatePhoneNumber(phoneNumber)) {
-            throw ReservationException("Invalid phone number format. Use XXX-XXX-XXXX.");
+    int addChild(int node, char c) {
+        int existing = childOf(node, c);
+        if (existing != -1) {
+            return existing;
         }
-        if (!validatePartySize(partySize)) {
-            throw ReservationException("Party size must be at least 1.");
+        int child = static_cast<int>(nodes.size());
+        nodes.emplace_back();
+        auto& children = nodes[node].children;
+        children.insert(lower_bound(children.begin(), children.end(), make_pair(c, INT_MIN)), make_pair(c, child));
+        return child;
+    }
+
+    int internName(const string& name) {
+        auto it = nameIds.find(name);
+        if (it != nameIds.end()) {
+            return it->second;
         }
-        if (!validateDate(date)) {
-            throw ReservationException("Invalid date format (use YYYY-MM-DD) or date is in the past.");
-        }
-        if (!validateTime(time, date)) {
-            throw ReservationException("Invalid time format (use HH:MM) or time is in the past for today.");
-        }
-        if (tableNumber < 0 || tableNumber >= tables.size()) {
-            throw ReservationException("Invalid table number. Must be between 1 and 10.");
-        }
-        if (!tables[tableNumber]) {
-            throw ReservationException("Selected table is already booked.");
+        int id = static_cast<int>(names.size());
+        names.push_back(name);
+        reservationIds.emplace_back();
+        nameIds[name] = id;
+        int node = 0;
+        for (char c : name) {
+            node = addChild(node, lower(c));
         }
-        tables[tableNumber] = false;
-
-        string reservationId = "ID " + to_string(nextReservationId) + "A";
-        while (reservationIdExists(reservationId)) {
-            nextReservationId++;
-            reservationId = "ID " + to_string(nextReservationId) + "A";
-        }
-        nextReservationId++;
-
-        reservations.emplace_back(reservationId, customerName, phoneNumber, partySize, date, time, tableNumber);
-        saveReservations();
-        logReservationAction("Customer", customerName, "Reserved table",
-                            "#" + to_string(tableNumber + 1) + " for " + to_string(partySize) + " on " + date + " at " + time,
-                            reservationId, customerName, phoneNumber, partySize, date, time, tableNumber);
-        return tableNumber;
+        nodes[node].nameIds.push_back(id);
+        return id;
     }
 
-    void cancelReservation(const string& reservationId, const string& customerName) {
-        string upperId = toUpperCase(reservationId);
-        if (!validateReservationId(upperId)) {
-            throw ReservationException("Invalid reservation ID format. Use 'ID <number>A', e.g., ID 1A.");
-        }
-        bool hasReservation = false;
-        int tableIndex = -1;
-        string phoneNumber, date, time;
-        int partySize;
-        for (const auto& res : reservations) {
-            if (res.id == upperId) {
-                hasReservation = true;
-                tableIndex = res.tableNumber;
-                phoneNumber = res.phoneNumber;
-                partySize = res.partySize;
-                date = res.date;
-                time = res.time;
-                break;
+    // A search pass collects names into found until it holds limit entries.
+    struct SearchState {
+        const string& query;
+        int distance;
+        size_t limit;
+        unordered_map<int, int>& seen; // name id -> distance it was found at
+        vector<int>& found;
+    };
+
+    // Depth-first in character order, so the subtree is visited alphabetically and a
+    // name always comes before the longer names it prefixes.
+    void collect(int node, SearchState& state) const {
+        for (int id : nodes[node].nameIds) {
+            if (state.found.size() >= state.limit) {
+                return;
             }
-        }
-        if (!hasReservation) {
-            throw ReservationException("No reservation to cancel.");
-        }
-        tables[tableIndex] = true;
-        auto it = reservations.begin();
-        while (it != reservations.end()) {
-            if (it->id == upperId) {
-                it = reservations.erase(it);
-            } else {
-                ++it;
+            if (!reservationIds[id].empty() && !state.seen.count(id)) {
+                state.seen[id] = state.distance;
+                state.found.push_back(id);
             }
         }
-        saveReservations();
-        logReservationAction("Customer", customerName, "Cancelled reservation", "ID " + upperId,
-                            upperId, customerName, phoneNumber, partySize, date, time, tableIndex);
-    }
-
-    void viewCustomerReservations(const string& customerName) {
-        cout << "\n--- Your Reservations ---\n";
-        bool hasReservations = false;
-        for (const auto& res : reservations) {
-            if (res.customerName == customerName) {
-                cout << "ID: " << res.id << ", Name: " << res.customerName
-                     << ", Contact: " << res.phoneNumber << ", Party Size: " << res.partySize
-                     << ", Date: " << res.date << ", Time: " << res.time
-                     << ", Table: " << res.tableNumber + 1 << endl;
-                hasReservations = true;
+        for (const auto& child : nodes[node].children) {
+            if (state.found.size() >= state.limit) {
+                return;
             }
-        }
-        if (!hasReservations) {
-            cout << "No reservation to view.\n";
+            collect(child.second, state);
         }
     }
 
-    void updateReservation(const string& reservationId, const string& customerName,
-                           const string& newId, const string& newName, const string& newPhone, int newPartySize,
-                           const string& newDate, const string& newTime, int newTableIndex) {
-        string upperId = toUpperCase(reservationId);
-        string upperNewId = newId == "0" ? "0" : toUpperCase(newId);
-        if (!validateReservationId(upperId)) {
-            throw ReservationException("Invalid reservation ID format. Use 'ID <number>A', e.g., ID 1A.");
+    // row[i] is the edit distance between query[0..i) and the path to node.
+    void searchNode(int node, const vector<int>& row, SearchState& state) const {
+        if (state.found.size() >= state.limit) {
+            return;
         }
-        bool hasReservation = false;
-        for (const auto& res : reservations) {
-            if (res.id == upperId) {
-                hasReservation = true;
-                break;
-            }
+        if (row.back() <= state.distance) {
+            // Every name below starts with a prefix this close to the query. Closer names
+            // were already taken by the earlier passes.
+            collect(node, state);
+            return;
         }
-        if (!hasReservation) {
-            throw ReservationException("No reservation to update.");
+        if (*min_element(row.begin(), row.end()) > state.distance) {
+            return;
         }
-
-        if (upperNewId != "0") {
-            if (!validateReservationId(upperNewId)) {
-                throw ReservationException("Invalid new reservation ID format. Use 'ID <number>A', e.g., ID 1A.");
-            }
-            if (reservationIdExists(upperNewId, upperId)) {
-                throw ReservationException("New reservation ID already exists. Choose a different ID.");
+        const string& query = state.query;
+        vector<int> nextRow(row.size());
+        for (const auto& child : nodes[node].children) {
+            nextRow[0] = row[0] + 1;
+            for (size_t i = 1; i < nextRow.size(); ++i) {
+                int substitution = row[i - 1] + (query[i - 1] == child.first ? 0 : 1);
+                nextRow[i] = min({nextRow[i - 1] + 1, row[i] + 1, substitution});
             }
+            searchNode(child.second, nextRow, state);
         }
-        if (newPhone != "0" && !validatePhoneNumber(newPhone)) {
-            throw ReservationException("Invalid phone number format. Use XXX-XXX-XXXX.");
+    }
+
+public:
+    NameSearchIndex() : nodes(1) {}
+
+    void add(const string& name, const string& id) {
+        reservationIds[internName(name)].push_back(id);
+    }
+
+    void remove(const string& name, const string& id) {
+        auto it = nameIds.find(name);
+        if (it == nameIds.end()) {
+            return;
         }
-        if (newPartySize != 0 && !validatePartySize(newPartySize)) {
-            throw ReservationException("Party size must be at least 1.");
+        auto& ids = reservationIds[it->second];
+        ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+    }
+
+    // Matches are ranked by edit distance to the closest prefix of the name, then
+    // alphabetically. Each distance is a separate pass that stops as soon as limit
+    // names are found, so common prefixes never enumerate their whole subtree.
+    vector<Match> search(const string& query, int maxDistance, size_t limit) const {
+        string lowered;
+        for (char c : query) {
+            lowered += lower(c);
         }
-        if (newDate != "0" && !validateDate(newDate)) {
-            throw ReservationException("Invalid date format (use YYYY-MM-DD) or date is in the past.");
+        vector<int> firstRow(lowered.size() + 1);
+        for (size_t i = 0; i < firstRow.size(); ++i) {
+            firstRow[i] = static_cast<int>(i);
         }
-        if (newTime != "0" && !validateTime(newTime, newDate != "0" ? newDate : CURRENT_DATE)) {
-            throw ReservationException("Invalid time format (use HH:MM) or time is in the past for today.");
+        unordered_map<int, int> seen;
+        vector<int> found;
+        for (int distance = 0; distance <= maxDistance && found.size() < limit; ++distance) {
+            SearchState state{lowered, distance, limit, seen, found};
+            searchNode(0, firstRow, state);
         }
 
-        int oldTableIndex = -1;
-        for (auto& res : reservations) {
-            if (res.id == upperId) {
-                oldTableIndex = res.tableNumber;
-                break;
-            }
-        }
-        if (newTableIndex != -1) {
-            if (newTableIndex < 0 || newTableIndex >= tables.size()) {
-                throw ReservationException("Invalid new table index.");
-            }
-            tables[oldTableIndex] = true;
-            if (!tables[newTableIndex]) {
-                tables[oldTableIndex] = false;
-                throw ReservationException("Selected table is already booked.");
-            }
-            tables[newTableIndex] = false;
-        } else {
-            newTableIndex = oldTableIndex;
+        vector<Match> matches;
+        for (int id : found) {
+            matches.push_back({names[id], seen[id], reservationIds[id]});
         }
+        return matches;
+    }
 
-        string finalId = upperId;
-        string finalName = customerName;
-        string finalPhone = "";
-        int finalPartySize = 0;
-        string finalDate = "";
-        string finalTime = "";
-        for (auto& res : reservations) {
-            if (res.id == upperId) {
-                finalPhone = res.phoneNumber;
-                finalPartySize = res.partySize;
-                finalDate = res.date;
-                finalTime = res.time;
-                if (upperNewId != "0") {
-                    res.id = upperNewId;
-                    finalId = upperNewId;
-                }
-                if (newName != "0") {
-                    res.customerName = newName;
-                    finalName = newName;
-                }
-                if (newPhone != "0") {
-                    res.phoneNumber = newPhone;
-                    finalPhone = newPhone;
-                }
-                if (newPartySize != 0) {
-                    res.partySize = newPartySize;
-                    finalPartySize = newPartySize;
-                }
-                if (newDate != "0") {
-                    res.date = newDate;
-                    finalDate = newDate;
-                }
-                if (newTime != "0") {
-                    res.time = newTime;
-                    finalTime = newTime;
-                }
-                res.tableNumber = newTableIndex;
-                break;
-            }
+    // The trie and the per-name ID lists; the names themselves are internPoolBytes().
+    size_t memoryBytes() const {
+        size_t bytes = heapBytes(reservationIds) + nodes.capacity() * sizeof(TrieNode);
+        for (const auto& node : nodes) {
+            bytes += heapBytes(node.children) + heapBytes(node.nameIds);
         }
-        saveReservations();
-        logReservationAction("Customer", customerName, "Updated reservation", "ID " + upperId,
-                            finalId, finalName, finalPhone, finalPartySize, finalDate, finalTime, newTableIndex);
+        return bytes;
     }
 
-    void viewLogs() {
-        cout << "--- System Logs ---\n\n";
-        ifstream logFile("logs.txt");
-        if (logFile.is_open()) {
-            string line;
-            while (getline(logFile, line)) {
-                cout << line << "\n";
-            }
-            logFile.close();
-        } else {
-            cout << "Unable to open log file.\n";
-        }
+    size_t internPoolBytes() const {
+        return heapBytes(names) + heapBytes(nameIds);
+    }
+
+    size_t internedNames() const {
+        return names.size();
     }
 };
 
-unique_ptr<ReservationManager> ReservationManager::instance = nullptr;
+// -------- Date-Ordered Schedule Index --------
+// Orders reservations by (date, time, table) so a day sheet or date range is one
+// tree descent plus a walk over the matching entries.
+struct ScheduleKey {
+    string date;
+    string time;
+    int tableNumber;
+    string id;
 
-// -------- Abstraction + Polymorphism --------
-class User {
-protected:
-    string username;
-    string role;
-public:
-    User(const string& name, const string& r, const string& password) : username(name), role(r) {
-        ReservationManager::getInstance().logLogin(role, name, password);
+    bool operator<(const ScheduleKey& other) const {
+        return tie(date, time, tableNumber, id) < tie(other.date, other.time, other.tableNumber, other.id);
     }
-    virtual bool showMenu() = 0;
-    virtual ~User() = default;
 };
 
-// Account database
-map<string, string> receptionistAccounts;
-map<string, string> customerAccounts;
+inline size_t heapBytes(const ScheduleKey& key) {
+    return heapBytes(key.date) + heapBytes(key.time) + heapBytes(key.id);
+}
 
-// -------- Helper Functions for Customer Accounts --------
-void saveCustomerAccounts(const map<string, string>& accounts) {
-    ofstream accountsFile("customer_accounts.txt");
-    if (!accountsFile.is_open()) {
-        cerr << "Error: Unable to open customer_accounts.txt for writing." << endl;
-        return;
+class ScheduleIndex {
+private:
+    set<ScheduleKey> entries;
+
+public:
+    void add(const Reservation& res) {
+        entries.insert({res.date, res.time, res.tableNumber, res.id});
     }
-    for (const auto& account : accounts) {
-        accountsFile << account.first << "|" << account.second << "\n";
+
+    void remove(const Reservation& res) {
+        entries.erase({res.date, res.time, res.tableNumber, res.id});
     }
-    accountsFile.close();
-}
 
-void loadCustomerAccounts(map<string, string>& accounts) {
-    ifstream accountsFile("customer_accounts.txt");
-    if (accountsFile.is_open()) {
-        string line;
-        while (getline(accountsFile, line)) {
-            stringstream ss(line);
-            string username, password;
-            getline(ss, username, '|');
-            getline(ss, password);
-            accounts[username] = password;
+    // IDs of reservations dated fromDate..toDate (inclusive), in service order.
+    vector<string> idsBetween(const string& fromDate, const string& toDate) const {
+        vector<string> ids;
+        for (auto it = entries.lower_bound({fromDate, "", INT_MIN, ""}); it != entries.end() && it->date <= toDate; ++it) {
+            ids.push_back(it->id);
         }
-        accountsFile.close();
+        return ids;
+    }
+
+    size_t memoryBytes() const {
+        return heapBytes(entries);
     }
+};
+
+// -------- Reservation Slots --------
+// A day is split into 15-minute slots and a reservation holds its table for two hours.
+const int SLOT_MINUTES = 15;
+const int SLOTS_PER_DAY = 24 * 60 / SLOT_MINUTES;
+const int RESERVATION_SLOTS = 120 / SLOT_MINUTES;
+
+int timeToSlot(const string& time) {
+    int hour = 0, minute = 0;
+    sscanf(time.c_str(), "%d:%d", &hour, &minute);
+    return (hour * 60 + minute) / SLOT_MINUTES;
 }
 
-// -------- Inheritance for Roles --------
-bool isValidCredential(const string& input) {
-    if (input.empty()) {
-        return false;
+string slotToTime(int slot) {
+    int minutes = slot * SLOT_MINUTES;
+    ostringstream oss;
+    oss << (minutes / 60 < 10 ? "0" : "") << minutes / 60 << ":" << (minutes % 60 < 10 ? "0" : "") << minutes % 60;
+    return oss.str();
+}
+
+// -------- Free-Table Scan Kernels --------
+// These work on slot-major bitmaps: wordsPerSlot words per slot, bit t set when table t
+// is booked. ORing the rows of a window gives every table booked at any point in it,
+// for all tables at once. Build with -mavx2 to get the AVX2 path; SSE2 is the x86-64
+// baseline, and other targets use the scalar loop.
+#if defined(__AVX2__)
+const char* const SCAN_KERNEL_NAME = "AVX2";
+#elif defined(__SSE2__)
+const char* const SCAN_KERNEL_NAME = "SSE2";
+#else
+const char* const SCAN_KERNEL_NAME = "scalar";
+#endif
+
+void orSlotRowsScalar(const uint64_t* bits, int wordsPerSlot, int firstSlot, int endSlot, uint64_t* out) {
+    for (int w = 0; w < wordsPerSlot; ++w) {
+        out[w] = 0;
+    }
+    for (int slot = firstSlot; slot < endSlot; ++slot) {
+        for (int w = 0; w < wordsPerSlot; ++w) {
+            out[w] |= bits[slot * wordsPerSlot + w];
+        }
     }
-    return none_of(input.begin(), input.end(), ::isspace);
 }
 
-class Customer : public User {
-public:
-    Customer(bool isNewAccount) : User("", "Customer", "") {
-        string name, password;
-        if (isNewAccount) {
-            bool usernameValid = false;
-            while (!usernameValid) {
-                cout << "Enter username (no spaces allowed): ";
-                getline(cin, name);
-                if (!isValidCredential(name)) {
-                    cout << "Error: Username cannot be empty or contain spaces.\n";
-                    continue;
-                }
-                if (customerAccounts.count(name)) {
-                    cout << "Account already exists. Please choose a different username.\n";
-                    continue;
-                }
-                usernameValid = true;
-            }
-            bool passwordValid = false;
-            while (!passwordValid) {
-                cout << "Enter password (no spaces allowed): ";
-                getline(cin, password);
-                if (!isValidCredential(password)) {
-                    cout << "Error: Password cannot be empty or contain spaces.\n";
-                    continue;
-                }
-                passwordValid = true;
-            }
-            customerAccounts[name] = password;
-            saveCustomerAccounts(customerAccounts);
-            cout << "Customer account created.\n";
-            ReservationManager::getInstance().logLogin("Customer", name, password);
-            username = name;
+// The window is one contiguous run of words. When wordsPerSlot divides the vector width
+// (1, 2 or 4 words, i.e. up to 256 tables), lane l of the accumulator always holds word
+// l % wordsPerSlot, so the run is ORed a full vector at a time and folded down at the end.
+// Wider floors fall back to the scalar loop.
+void orSlotRows(const uint64_t* bits, int wordsPerSlot, int firstSlot, int endSlot, uint64_t* out) {
+    const uint64_t* run = bits + static_cast<size_t>(firstSlot) * wordsPerSlot;
+    size_t length = static_cast<size_t>(endSlot - firstSlot) * wordsPerSlot;
+    size_t i = 0;
+#if defined(__AVX2__)
+    if (wordsPerSlot == 4) {
+        __m256i acc = _mm256_setzero_si256();
+        for (; i < length; i += 4) {
+            acc = _mm256_or_si256(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(run + i)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), acc);
+        return;
+    }
+#endif
+#if defined(__SSE2__)
+    if (wordsPerSlot <= 2) {
+        __m128i acc = _mm_setzero_si128();
+#if defined(__AVX2__)
+        __m256i wide = _mm256_setzero_si256();
+        for (; i + 4 <= length; i += 4) {
+            wide = _mm256_or_si256(wide, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(run + i)));
+        }
+        acc = _mm_or_si128(_mm256_castsi256_si128(wide), _mm256_extracti128_si256(wide, 1));
+#endif
+        for (; i + 2 <= length; i += 2) {
+            acc = _mm_or_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(run + i)));
+        }
+        if (wordsPerSlot == 2) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), acc);
         } else {
-            bool credentialsValid = false;
-            while (!credentialsValid) {
-                cout << "Enter username: ";
-                getline(cin, name);
-                cout << "Enter password: ";
-                getline(cin, password);
-                if (customerAccounts.count(name) && customerAccounts[name] == password) {
-                    credentialsValid = true;
-                    ReservationManager::getInstance().logLogin("Customer", name, password);
-                    username = name;
-                } else {
-                    cout << "Invalid credentials. Please try again.\n";
-                }
-            }
+            acc = _mm_or_si128(acc, _mm_unpackhi_epi64(acc, acc));
+            out[0] = static_cast<uint64_t>(_mm_cvtsi128_si64(acc)) | (i < length ? run[i] : 0);
         }
+        return;
     }
+#endif
+    orSlotRowsScalar(bits, wordsPerSlot, firstSlot, endSlot, out);
+}
 
-    bool showMenu() override {
-        bool isRunning = true;
-        while (isRunning) {
-            string input;
-            int choice;
-            cout << "\n[Customer Menu - " << username << "]\n";
-            cout << "1. View My Reservations\n";
-            cout << "2. View Availability\n";
-            cout << "3. Reserve Table\n";
-            cout << "4. Update Reservation\n";
-            cout << "5. Cancel Reservation\n";
-            cout << "6. Exit\nChoice: ";
-            getline(cin, input);
-
-            if (!validateNumericInput(input, choice, 1, 6)) {
-                cout << "Invalid choice. Please enter a single number between 1 and 6.\n";
-                continue;
-            }
-
-            switch (choice) {
+// Bit t of the result is set when table t can seat partySize.
+vector<uint64_t> tablesWithCapacity(const vector<int>& capacities, int partySize) {
+    vector<uint64_t> mask((capacities.size() + 63) / 64, 0);
+    for (size_t table = 0; table < capacities.size(); ++table) {
+        if (capacities[table] >= partySize) {
+            mask[table / 64] |= 1ULL << (table % 64);
+        }
+    }
+    return mask;
+}
+
+// -------- Slot Availability Cores --------
+// Both cores store one bitmap per slot with a bit per table (slot-major), so checking a
+// table over a window reads one bit per slot and whole-floor queries read whole words.
+
+// Sized at runtime, for venues whose layout can change.
+class DynamicAvailabilityCore {
+private:
+    int tableCount;
+    int slotCount;
+    int wordsPerSlot;
+    vector<uint64_t> bits;
+
+    uint64_t& word(int slot, int table) {
+        return bits[slot * wordsPerSlot + table / 64];
+    }
+
+    uint64_t word(int slot, int table) const {
+        return bits[slot * wordsPerSlot + table / 64];
+    }
+
+    void checkSlots(int firstSlot, int slots) const {
+        if (firstSlot < 0 || slots < 0 || firstSlot + slots > slotCount) {
+            throw out_of_range("Slot range outside the availability core.");
+        }
+    }
+
+    void checkRange(int table, int firstSlot, int slots) const {
+        if (table < 0 || table >= tableCount) {
+            throw out_of_range("Table outside the availability core.");
+        }
+        checkSlots(firstSlot, slots);
+    }
+
+public:
+    DynamicAvailabilityCore(int tables, int slots)
+        : tableCount(tables), slotCount(slots), wordsPerSlot((tables + 63) / 64), bits(slots * ((tables + 63) / 64), 0) {}
+
+    int getTableCount() const {
+        return tableCount;
+    }
+
+    int getSlotCount() const {
+        return slotCount;
+    }
+
+    bool isFree(int table, int firstSlot, int slots) const {
+        checkRange(table, firstSlot, slots);
+        uint64_t mask = 1ULL << (table % 64);
+        for (int slot = firstSlot; slot < firstSlot + slots; ++slot) {
+            if (word(slot, table) & mask) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool reserve(int table, int firstSlot, int slots) {
+        if (!isFree(table, firstSlot, slots)) {
+            return false;
+        }
+        uint64_t mask = 1ULL << (table % 64);
+        for (int slot = firstSlot; slot < firstSlot + slots; ++slot) {
+            word(slot, table) |= mask;
+        }
+        return true;
+    }
+
+    void release(int table, int firstSlot, int slots) {
+        checkRange(table, firstSlot, slots);
+        uint64_t mask = ~(1ULL << (table % 64));
+        for (int slot = firstSlot; slot < firstSlot + slots; ++slot) {
+            word(slot, table) &= mask;
+        }
+    }
+
+    void clear() {
+        fill(bits.begin(), bits.end(), 0);
+    }
+
+    // Bit t is set when table t is free for the whole window [firstSlot, firstSlot + slots).
+    vector<uint64_t> freeTables(int firstSlot, int slots) const {
+        checkSlots(firstSlot, slots);
+        vector<uint64_t> free(wordsPerSlot);
+        orSlotRows(bits.data(), wordsPerSlot, firstSlot, firstSlot + slots, free.data());
+        for (int w = 0; w < wordsPerSlot; ++w) {
+            free[w] = ~free[w];
+        }
+        if (tableCount % 64) {
+            free[wordsPerSlot - 1] &= (1ULL << (tableCount % 64)) - 1;
+        }
+        return free;
+    }
+
+    // First window start at or after startSlot where one of the eligible tables is free
+    // for the whole reservation. Returns -1 if none is left today.
+    int findFirstFreeSlot(int startSlot, int slots, const vector<uint64_t>& eligible, int& table) const {
+        if (slots < 0 || eligible.size() < static_cast<size_t>(wordsPerSlot)) {
+            throw out_of_range("Window or table mask does not fit the availability core.");
+        }
+        vector<uint64_t> booked(wordsPerSlot);
+        for (int slot = max(startSlot, 0); slot + slots <= slotCount; ++slot) {
+            orSlotRows(bits.data(), wordsPerSlot, slot, slot + slots, booked.data());
+            for (int w = 0; w < wordsPerSlot; ++w) {
+                uint64_t candidates = ~booked[w] & eligible[w];
+                if (candidates) {
+                    table = w * 64 + __builtin_ctzll(candidates);
+                    return slot;
+                }
+            }
+        }
+        return -1;
+    }
+
+    const uint64_t* data() const {
+        return bits.data();
+    }
+};
+
+// Fixed at compile time, for venues whose layout never changes. The bitmaps live in
+// std::arrays, and the Span overloads take the reservation length as a constant too,
+// so their loops are fully unrolled.
+template <int Tables, int Slots>
+class FixedAvailabilityCore {
+private:
+    static const int WORDS_PER_SLOT = (Tables + 63) / 64;
+    array<array<uint64_t, WORDS_PER_SLOT>, Slots> bits{};
+
+    static void checkRange(int table, int firstSlot, int slots) {
+        if (table < 0 || table >= Tables || firstSlot < 0 || slots < 0 || firstSlot + slots > Slots) {
+            throw out_of_range("Table or slot range outside the availability core.");
+        }
+    }
+
+public:
+    template <int Span>
+    bool isFree(int table, int firstSlot) const {
+        checkRange(table, firstSlot, Span);
+        const uint64_t mask = 1ULL << (table % 64);
+        const uint64_t* word = &bits[firstSlot][table / 64];
+        for (int i = 0; i < Span; ++i) {
+            if (word[i * WORDS_PER_SLOT] & mask) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <int Span>
+    bool reserve(int table, int firstSlot) {
+        if (!isFree<Span>(table, firstSlot)) {
+            return false;
+        }
+        const uint64_t mask = 1ULL << (table % 64);
+        uint64_t* word = &bits[firstSlot][table / 64];
+        for (int i = 0; i < Span; ++i) {
+            word[i * WORDS_PER_SLOT] |= mask;
+        }
+        return true;
+    }
+
+    static constexpr int getTableCount() {
+        return Tables;
+    }
+
+    static constexpr int getSlotCount() {
+        return Slots;
+    }
+
+    bool isFree(int table, int firstSlot, int slots) const {
+        checkRange(table, firstSlot, slots);
+        uint64_t mask = 1ULL << (table % 64);
+        for (int slot = firstSlot; slot < firstSlot + slots; ++slot) {
+            if (bits[slot][table / 64] & mask) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool reserve(int table, int firstSlot, int slots) {
+        if (!isFree(table, firstSlot, slots)) {
+            return false;
+        }
+        uint64_t mask = 1ULL << (table % 64);
+        for (int slot = firstSlot; slot < firstSlot + slots; ++slot) {
+            bits[slot][table / 64] |= mask;
+        }
+        return true;
+    }
+
+    void release(int table, int firstSlot, int slots) {
+        checkRange(table, firstSlot, slots);
+        uint64_t mask = ~(1ULL << (table % 64));
+        for (int slot = firstSlot; slot < firstSlot + slots; ++slot) {
+            bits[slot][table / 64] &= mask;
+        }
+    }
+
+    void clear() {
+        for (auto& slot : bits) {
+            slot.fill(0);
+        }
+    }
+};
+
+// -------- Availability Heatmap --------
+// Tables x slots occupancy grid per date, held in a FixedAvailabilityCore and kept
+// together with its rendered text. A grid is built the first time a date is viewed;
+// after that every mutation only rewrites the cells of the slots it touched, and views
+// reuse the cached text. A reservation that runs past midnight also fills the start of
+// the next date's grid.
+// At most MAX_CACHED_DAYS grids are kept; the least recently viewed goes first.
+template <int Tables>
+class AvailabilityHeatmap {
+private:
+    static const int ROW_PREFIX = 10; // "Table 10 |"
+    static const size_t MAX_CACHED_DAYS = 62;
+
+    struct DayGrid {
+        FixedAvailabilityCore<Tables, SLOTS_PER_DAY> booked;
+        vector<string> rows;    // rendered line per table
+        string screen;          // header + rows, rebuilt only when stale
+        bool screenStale = true;
+        list<string>::iterator recent; // position in recency
+    };
+    map<string, DayGrid> days;
+    list<string> recency; // most recently viewed date first
+
+    static string formatRowPrefix(int table) {
+        string label = "Table " + to_string(table + 1);
+        label.resize(ROW_PREFIX - 1, ' ');
+        return label + "|";
+    }
+
+    // The date offset days away, or "" if date does not parse.
+    static string shiftDate(const string& date, int offset) {
+        int64_t minutes;
+        if (!Clock::parseInstant(date + " 00:00", minutes)) {
+            return "";
+        }
+        return dateFromDays(static_cast<int>(minutes / 1440) + offset);
+    }
+
+    // firstSlot may be negative for a reservation that started the day before.
+    void patch(DayGrid& grid, int table, int firstSlot, int delta) {
+        if (table < 0 || table >= Tables) {
+            return;
+        }
+        int begin = max(firstSlot, 0);
+        int end = min(firstSlot + RESERVATION_SLOTS, SLOTS_PER_DAY);
+        if (begin >= end) {
+            return;
+        }
+        if (delta > 0) {
+            // Slot claims keep a table's reservations apart, so this only fails on a
+            // slot an overlapping record already marked.
+            for (int slot = begin; slot < end; ++slot) {
+                grid.booked.reserve(table, slot, 1);
+            }
+        } else {
+            grid.booked.release(table, begin, end - begin);
+        }
+        for (int slot = begin; slot < end; ++slot) {
+            grid.rows[table][ROW_PREFIX + slot] = grid.booked.isFree(table, slot, 1) ? '.' : '#';
+        }
+        grid.screenStale = true;
+    }
+
+    void update(const Reservation& res, int delta) {
+        int firstSlot = timeToSlot(res.time);
+        auto it = days.find(res.date);
+        if (it != days.end()) {
+            patch(it->second, res.tableNumber, firstSlot, delta);
+        }
+        if (firstSlot + RESERVATION_SLOTS > SLOTS_PER_DAY) {
+            auto next = days.find(shiftDate(res.date, 1));
+            if (next != days.end()) {
+                patch(next->second, res.tableNumber, firstSlot - SLOTS_PER_DAY, delta);
+            }
+        }
+    }
+
+public:
+    bool isCached(const string& date) const {
+        return days.count(date) > 0;
+    }
+
+    // daySheet returns the reservations on a date; the previous date's are needed for
+    // those running past midnight into this one.
+    void build(const string& date, const function<vector<Reservation>(const string&)>& daySheet) {
+        DayGrid grid;
+        for (int table = 0; table < Tables; ++table) {
+            grid.rows.push_back(formatRowPrefix(table) + string(SLOTS_PER_DAY, '.'));
+        }
+        for (const auto& res : daySheet(date)) {
+            patch(grid, res.tableNumber, timeToSlot(res.time), 1);
+        }
+        string previous = shiftDate(date, -1);
+        if (!previous.empty()) {
+            for (const auto& res : daySheet(previous)) {
+                patch(grid, res.tableNumber, timeToSlot(res.time) - SLOTS_PER_DAY, 1);
+            }
+        }
+        auto it = days.find(date);
+        if (it != days.end()) {
+            recency.erase(it->second.recent);
+            days.erase(it);
+        }
+        recency.push_front(date);
+        grid.recent = recency.begin();
+        days.emplace(date, std::move(grid));
+        while (days.size() > MAX_CACHED_DAYS) {
+            days.erase(recency.back());
+            recency.pop_back();
+        }
+    }
+
+    void add(const Reservation& res) {
+        update(res, 1);
+    }
+
+    void remove(const Reservation& res) {
+        update(res, -1);
+    }
+
+    const string& render(const string& date) {
+        DayGrid& grid = days.at(date);
+        recency.splice(recency.begin(), recency, grid.recent);
+        if (grid.screenStale) {
+            ostringstream out;
+            out << string(ROW_PREFIX, ' ');
+            for (int hour = 0; hour < 24; ++hour) {
+                out << (hour < 10 ? "0" : "") << hour << (hour < 23 ? string(60 / SLOT_MINUTES - 2, ' ') : "");
+            }
+            out << "\n";
+            for (const auto& row : grid.rows) {
+                out << row << "\n";
+            }
+            out << "('.' = free, '#' = booked, one column per " << SLOT_MINUTES << " minutes)\n";
+            grid.screen = out.str();
+            grid.screenStale = false;
+        }
+        return grid.screen;
+    }
+
+    size_t memoryBytes() const {
+        size_t bytes = days.size() * (TREE_NODE_OVERHEAD + sizeof(pair<const string, DayGrid>));
+        for (const auto& day : days) {
+            bytes += heapBytes(day.first) + heapBytes(day.second.rows)
+                     + heapBytes(day.second.screen);
+        }
+        for (const auto& date : recency) {
+            bytes += 2 * sizeof(void*) + sizeof(string) + heapBytes(date);
+        }
+        return bytes;
+    }
+};
+
+// -------- Lock-Free Slot Claiming --------
+// Same slot-major layout as DynamicAvailabilityCore, but every word is atomic and each
+// slot has two bits per table: held, set by compare-and-swap while a booking is being
+// claimed, and booked, set once all of its slots are held. A claim takes its slots in
+// ascending order. Meeting a booked slot it backs out and fails; meeting one that is only
+// held, it waits for that rival to finish or back out, so a claim is never refused over
+// a booking that does not happen. Waits only run towards later slots, so they cannot
+// form a cycle. No mutex is held while claiming.
+class AtomicSlotBitmap {
+private:
+    int tableCount;
+    int slotCount;
+    int wordsPerSlot;
+    unique_ptr<atomic<uint64_t>[]> held;
+    unique_ptr<atomic<uint64_t>[]> booked;
+
+    size_t at(int slot, int table) const {
+        return static_cast<size_t>(slot) * wordsPerSlot + table / 64;
+    }
+
+    void checkRange(int table, int firstSlot, int slots) const {
+        if (table < 0 || table >= tableCount || firstSlot < 0 || slots < 0 || firstSlot + slots > slotCount) {
+            throw out_of_range("Slot range outside the claim bitmap.");
+        }
+    }
+
+public:
+    size_t memoryBytes() const {
+        return 2 * static_cast<size_t>(slotCount) * wordsPerSlot * sizeof(uint64_t);
+    }
+
+    AtomicSlotBitmap(int tables, int slots)
+        : tableCount(tables), slotCount(slots), wordsPerSlot((tables + 63) / 64),
+          held(new atomic<uint64_t>[slots * ((tables + 63) / 64)]),
+          booked(new atomic<uint64_t>[slots * ((tables + 63) / 64)]) {
+        for (int i = 0; i < slotCount * wordsPerSlot; ++i) {
+            held[i].store(0, memory_order_relaxed);
+            booked[i].store(0, memory_order_relaxed);
+        }
+    }
+
+    // Takes the held bits of the range; false, with nothing taken, if any slot is booked.
+    bool hold(int table, int firstSlot, int slots) {
+        checkRange(table, firstSlot, slots);
+        const uint64_t mask = 1ULL << (table % 64);
+        for (int slot = firstSlot; slot < firstSlot + slots; ++slot) {
+            atomic<uint64_t>& target = held[at(slot, table)];
+            uint64_t current = target.load(memory_order_relaxed);
+            do {
+                while (current & mask) {
+                    if (booked[at(slot, table)].load(memory_order_acquire) & mask) {
+                        unhold(table, firstSlot, slot - firstSlot);
+                        return false;
+                    }
+                    this_thread::yield();
+                    current = target.load(memory_order_relaxed);
+                }
+            } while (!target.compare_exchange_weak(current, current | mask, memory_order_acq_rel, memory_order_relaxed));
+        }
+        return true;
+    }
+
+    // Marks a held range booked.
+    void commit(int table, int firstSlot, int slots) {
+        checkRange(table, firstSlot, slots);
+        const uint64_t mask = 1ULL << (table % 64);
+        for (int slot = firstSlot; slot < firstSlot + slots; ++slot) {
+            booked[at(slot, table)].fetch_or(mask, memory_order_release);
+        }
+    }
+
+    // Backs out a held range that was never committed.
+    void unhold(int table, int firstSlot, int slots) {
+        checkRange(table, firstSlot, slots);
+        const uint64_t mask = ~(1ULL << (table % 64));
+        for (int slot = firstSlot; slot < firstSlot + slots; ++slot) {
+            held[at(slot, table)].fetch_and(mask, memory_order_acq_rel);
+        }
+    }
+
+    bool claim(int table, int firstSlot, int slots) {
+        if (!hold(table, firstSlot, slots)) {
+            return false;
+        }
+        commit(table, firstSlot, slots);
+        return true;
+    }
+
+    // Clears booked before held, so a waiting rival never sees a held slot as booked
+    // after it has been given up.
+    void release(int table, int firstSlot, int slots) {
+        checkRange(table, firstSlot, slots);
+        const uint64_t mask = ~(1ULL << (table % 64));
+        for (int slot = firstSlot; slot < firstSlot + slots; ++slot) {
+            booked[at(slot, table)].fetch_and(mask, memory_order_acq_rel);
+            held[at(slot, table)].fetch_and(mask, memory_order_acq_rel);
+        }
+    }
+
+    bool isBooked(int table, int firstSlot, int slots) const {
+        checkRange(table, firstSlot, slots);
+        const uint64_t mask = 1ULL << (table % 64);
+        for (int slot = firstSlot; slot < firstSlot + slots; ++slot) {
+            if (!(booked[at(slot, table)].load(memory_order_acquire) & mask)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // A plain copy of the booked bits for the scan kernels; it may be stale by the time
+    // it is used.
+    DynamicAvailabilityCore snapshot() const {
+        DynamicAvailabilityCore copy(tableCount, slotCount);
+        for (int slot = 0; slot < slotCount; ++slot) {
+            for (int table = 0; table < tableCount; ++table) {
+                if (booked[at(slot, table)].load(memory_order_acquire) & (1ULL << (table % 64))) {
+                    copy.reserve(table, slot, 1);
+                }
+            }
+        }
+        return copy;
+    }
+};
+
+// One bitmap per day. Looking a day up takes a shared lock (exclusive only the first time
+// a day is seen); the claim itself never does, and it alone decides whether a booking
+// goes ahead. A reservation covers RESERVATION_SLOTS slots from its start and carries
+// past midnight into the next day's bitmap. Claims on a table outside the board, or at a
+// date or time that does not parse, fail; releasing one does nothing.
+class SlotClaimBoard {
+private:
+    struct Segment {
+        int64_t day;
+        int firstSlot;
+        int slots;
+    };
+
+    int tableCount;
+    mutable shared_mutex daysMutex;
+    unordered_map<int64_t, unique_ptr<AtomicSlotBitmap>> days;
+
+    AtomicSlotBitmap& day(int64_t number) {
+        {
+            shared_lock<shared_mutex> lock(daysMutex);
+            auto it = days.find(number);
+            if (it != days.end()) {
+                return *it->second;
+            }
+        }
+        unique_lock<shared_mutex> lock(daysMutex);
+        auto& slot = days[number];
+        if (!slot) {
+            slot.reset(new AtomicSlotBitmap(tableCount, SLOTS_PER_DAY));
+        }
+        return *slot;
+    }
+
+    // The absolute slots [first, end) split at day boundaries, earliest first.
+    static vector<Segment> segments(int64_t first, int64_t end) {
+        vector<Segment> parts;
+        while (first < end) {
+            int64_t number = first / SLOTS_PER_DAY;
+            int64_t dayEnd = min(end, (number + 1) * SLOTS_PER_DAY);
+            parts.push_back({number, static_cast<int>(first - number * SLOTS_PER_DAY), static_cast<int>(dayEnd - first)});
+            first = dayEnd;
+        }
+        return parts;
+    }
+
+    bool hold(int table, int64_t first, int64_t end) {
+        vector<Segment> parts = segments(first, end);
+        for (size_t i = 0; i < parts.size(); ++i) {
+            if (!day(parts[i].day).hold(table, parts[i].firstSlot, parts[i].slots)) {
+                while (i-- > 0) {
+                    day(parts[i].day).unhold(table, parts[i].firstSlot, parts[i].slots);
+                }
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void commit(int table, int64_t first, int64_t end) {
+        for (const Segment& part : segments(first, end)) {
+            day(part.day).commit(table, part.firstSlot, part.slots);
+        }
+    }
+
+    void unhold(int table, int64_t first, int64_t end) {
+        for (const Segment& part : segments(first, end)) {
+            day(part.day).unhold(table, part.firstSlot, part.slots);
+        }
+    }
+
+    void release(int table, int64_t first, int64_t end) {
+        for (const Segment& part : segments(first, end)) {
+            day(part.day).release(table, part.firstSlot, part.slots);
+        }
+    }
+
+    bool validTable(int table) const {
+        return table >= 0 && table < tableCount;
+    }
+
+public:
+    explicit SlotClaimBoard(int tables) : tableCount(tables) {}
+
+    // The absolute slot (counted from 1970-01-01) a reservation starts in; false if the
+    // date or time does not parse.
+    static bool windowStart(const string& date, const string& time, int64_t& first) {
+        int64_t minutes;
+        if (!Clock::parseInstant(date + " " + time, minutes) || minutes < 0) {
+            return false;
+        }
+        first = minutes / SLOT_MINUTES;
+        return true;
+    }
+
+    bool claim(const string& date, const string& time, int table) {
+        int64_t first;
+        if (!validTable(table) || !windowStart(date, time, first) || !hold(table, first, first + RESERVATION_SLOTS)) {
+            return false;
+        }
+        commit(table, first, first + RESERVATION_SLOTS);
+        return true;
+    }
+
+    void release(const string& date, const string& time, int table) {
+        int64_t first;
+        if (validTable(table) && windowStart(date, time, first)) {
+            release(table, first, first + RESERVATION_SLOTS);
+        }
+    }
+
+    // Claims the new window before letting go of the old one, so a failed move leaves the
+    // old claim exactly as it was. On the same table only the slots the windows do not
+    // share change hands. An old window that was never claimable is simply not released.
+    bool move(const string& oldDate, const string& oldTime, int oldTable,
+              const string& date, const string& time, int table) {
+        int64_t first;
+        if (!validTable(table) || !windowStart(date, time, first)) {
+            return false;
+        }
+        int64_t end = first + RESERVATION_SLOTS;
+        int64_t oldFirst;
+        if (!validTable(oldTable) || !windowStart(oldDate, oldTime, oldFirst)) {
+            if (!hold(table, first, end)) {
+                return false;
+            }
+            commit(table, first, end);
+            return true;
+        }
+        int64_t oldEnd = oldFirst + RESERVATION_SLOTS;
+        if (oldTable != table || end <= oldFirst || oldEnd <= first) {
+            if (!hold(table, first, end)) {
+                return false;
+            }
+            commit(table, first, end);
+            release(oldTable, oldFirst, oldEnd);
+            return true;
+        }
+        int64_t below = min(oldFirst, end);
+        int64_t above = max(oldEnd, first);
+        if (!hold(table, first, below)) {
+            return false;
+        }
+        if (!hold(table, above, end)) {
+            unhold(table, first, below);
+            return false;
+        }
+        commit(table, first, below);
+        commit(table, above, end);
+        release(table, oldFirst, max(oldFirst, first));
+        release(table, min(oldEnd, end), oldEnd);
+        return true;
+    }
+
+    // True if every slot of the reservation starting at time is booked on that table.
+    bool isClaimed(const string& date, const string& time, int table) {
+        int64_t first;
+        if (!validTable(table) || !windowStart(date, time, first)) {
+            return false;
+        }
+        for (const Segment& part : segments(first, first + RESERVATION_SLOTS)) {
+            if (!day(part.day).isBooked(table, part.firstSlot, part.slots)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Offer another table at the same time, or else the earliest later time that day with
+    // any table free for a full reservation.
+    string suggestAlternative(const string& date, const string& time) {
+        int64_t first;
+        if (!windowStart(date, time, first)) {
+            return "No other table is free later on " + date + ".";
+        }
+        DynamicAvailabilityCore core = day(first / SLOTS_PER_DAY).snapshot();
+        int firstSlot = static_cast<int>(first % SLOTS_PER_DAY);
+        if (firstSlot + RESERVATION_SLOTS <= SLOTS_PER_DAY) {
+            vector<uint64_t> free = core.freeTables(firstSlot, RESERVATION_SLOTS);
+            for (size_t w = 0; w < free.size(); ++w) {
+                if (free[w]) {
+                    int table = static_cast<int>(w * 64 + __builtin_ctzll(free[w]));
+                    return "Table " + to_string(table + 1) + " is free on " + date + " at " + time + ".";
+                }
+            }
+        }
+        vector<uint64_t> everyTable((tableCount + 63) / 64, 0);
+        for (int table = 0; table < tableCount; ++table) {
+            everyTable[table / 64] |= 1ULL << (table % 64);
+        }
+        int table;
+        int slot = core.findFirstFreeSlot(firstSlot + 1, RESERVATION_SLOTS, everyTable, table);
+        if (slot < 0) {
+            return "No other table is free later on " + date + ".";
+        }
+        return "Table " + to_string(table + 1) + " is free on " + date + " from " + slotToTime(slot) + ".";
+    }
+
+    size_t memoryBytes() const {
+        shared_lock<shared_mutex> lock(daysMutex);
+        size_t bytes = days.bucket_count() * sizeof(void*);
+        for (const auto& day : days) {
+            bytes += HASH_NODE_OVERHEAD + sizeof(day) + sizeof(AtomicSlotBitmap) + day.second->memoryBytes();
+        }
+        return bytes;
+    }
+};
+
+// -------- Reservation Expiry --------
+// A hashed timing wheel keyed by the slot a reservation ends in. Each bucket covers one
+// 15-minute slot and the wheel turns once every BUCKETS slots (about six weeks); entries
+// further out stay in their bucket until the wheel comes round to their slot. Scheduling and cancelling
+// are O(1), and advancing the clock only visits the buckets it passes, so the cost does
+// not grow with the size of the book.
+class ExpiryWheel {
+public:
+    static const int BUCKETS = 4096;
+
+private:
+    static const uint32_t NONE = UINT32_MAX;
+
+    struct Entry {
+        int64_t slot;      // absolute slot the reservation ends in
+        const string* id;  // key in byId, stable for the entry's lifetime
+        uint32_t prev;
+        uint32_t next;
+        int table;
+    };
+
+    vector<Entry> entries; // slab; unused entries are chained through next from freeHead
+    uint32_t freeHead = NONE;
+    vector<uint32_t> buckets;
+    vector<uint32_t> overdue; // scheduled at or before the last slot visited
+    unordered_map<string, uint32_t> byId;
+    int64_t lastSlot; // every entry ending at or before this slot has fired
+    uint64_t expired = 0;
+
+    void link(uint32_t index) {
+        Entry& entry = entries[index];
+        uint32_t& head = buckets[entry.slot % BUCKETS];
+        entry.prev = NONE;
+        entry.next = head;
+        if (head != NONE) {
+            entries[head].prev = index;
+        }
+        head = index;
+    }
+
+    void unlink(uint32_t index) {
+        Entry& entry = entries[index];
+        if (entry.prev != NONE) {
+            entries[entry.prev].next = entry.next;
+        } else {
+            buckets[entry.slot % BUCKETS] = entry.next;
+        }
+        if (entry.next != NONE) {
+            entries[entry.next].prev = entry.prev;
+        }
+    }
+
+    void release(uint32_t index) {
+        entries[index].id = nullptr;
+        entries[index].next = freeHead;
+        freeHead = index;
+    }
+
+public:
+    explicit ExpiryWheel(int64_t nowMinute) : buckets(BUCKETS, NONE), lastSlot(nowMinute / SLOT_MINUTES) {}
+
+    // endMinute is minutes since 1970-01-01; the entry fires once the clock reaches it.
+    void schedule(const string& id, int table, int64_t endMinute) {
+        cancel(id);
+        int64_t slot = (endMinute + SLOT_MINUTES - 1) / SLOT_MINUTES;
+        uint32_t index;
+        if (freeHead != NONE) {
+            index = freeHead;
+            freeHead = entries[index].next;
+        } else {
+            index = static_cast<uint32_t>(entries.size());
+            entries.emplace_back();
+        }
+        auto key = byId.emplace(id, index).first;
+        entries[index] = {slot, &key->first, NONE, NONE, table};
+        if (slot <= lastSlot) {
+            entries[index].prev = entries[index].next = index; // marks an overdue entry
+            overdue.push_back(index);
+        } else {
+            link(index);
+        }
+    }
+
+    // Returns the table the entry held, or -1 if id had nothing scheduled.
+    int cancel(const string& id) {
+        auto it = byId.find(id);
+        if (it == byId.end()) {
+            return -1;
+        }
+        uint32_t index = it->second;
+        int table = entries[index].table;
+        if (entries[index].next == index) {
+            overdue.erase(find(overdue.begin(), overdue.end(), index));
+        } else {
+            unlink(index);
+        }
+        byId.erase(it);
+        release(index);
+        return table;
+    }
+
+    // Fires onExpire(id, table) for every entry ending at or before nowMinute.
+    void advance(int64_t nowMinute, const function<void(const string&, int)>& onExpire) {
+        auto fire = [&](uint32_t index) {
+            onExpire(*entries[index].id, entries[index].table);
+            byId.erase(*entries[index].id);
+            release(index);
+            expired++;
+        };
+        for (uint32_t index : overdue) {
+            fire(index);
+        }
+        overdue.clear();
+
+        int64_t target = nowMinute / SLOT_MINUTES;
+        if (target <= lastSlot) {
+            return;
+        }
+        // A jump of more than a turn visits each bucket once.
+        int64_t first = max(lastSlot + 1, target - BUCKETS + 1);
+        for (int64_t slot = first; slot <= target; ++slot) {
+            uint32_t index = buckets[slot % BUCKETS];
+            while (index != NONE) {
+                uint32_t next = entries[index].next;
+                if (entries[index].slot <= target) {
+                    unlink(index);
+                    fire(index);
+                }
+                index = next;
+            }
+        }
+        lastSlot = target;
+    }
+
+    size_t pending() const {
+        return byId.size();
+    }
+
+    uint64_t expiredCount() const {
+        return expired;
+    }
+
+    size_t memoryBytes() const {
+        return entries.capacity() * sizeof(Entry) + buckets.capacity() * sizeof(uint32_t)
+               + overdue.capacity() * sizeof(uint32_t) + heapBytes(byId);
+    }
+};
+
+// -------- Reminder Timers --------
+// A hierarchical timing wheel with one-minute resolution: four levels of 64 slots cover
+// about 32 years, and a timer sits in the lowest level whose span reaches its due time.
+// When level 0 wraps, the next level's current slot is cascaded down, so every timer is
+// moved at most three times before it fires. Schedule, reschedule and cancel are O(1);
+// timers are 20-byte slab entries addressed by index, so millions of them fit in tens of
+// megabytes.
+class TimerWheel {
+public:
+    static const uint32_t NONE = UINT32_MAX;
+
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const uint32_t SLOTS = 1 << SLOT_BITS;
+
+    struct Timer {
+        uint32_t due;     // minutes after base
+        uint32_t payload;
+        uint32_t prev;
+        uint32_t next;
+        uint8_t level;    // LEVELS while the entry is free
+    };
+
+    vector<Timer> timers;
+    uint32_t freeHead = NONE;
+    array<array<uint32_t, SLOTS>, LEVELS> slots;
+    int64_t base;      // minute the wheel counts from
+    uint32_t now = 0;  // minutes after base already processed
+    size_t live = 0;
+
+    uint32_t& head(const Timer& timer) {
+        return slots[timer.level][(timer.due >> (SLOT_BITS * timer.level)) & (SLOTS - 1)];
+    }
+
+    void link(uint32_t index) {
+        Timer& timer = timers[index];
+        uint32_t delta = timer.due - now;
+        int level = 0;
+        while (level < LEVELS - 1 && delta >= (1u << (SLOT_BITS * (level + 1)))) {
+            ++level;
+        }
+        timer.level = level;
+        uint32_t& first = head(timer);
+        timer.prev = NONE;
+        timer.next = first;
+        if (first != NONE) {
+            timers[first].prev = index;
+        }
+        first = index;
+    }
+
+    void unlink(uint32_t index) {
+        Timer& timer = timers[index];
+        if (timer.prev != NONE) {
+            timers[timer.prev].next = timer.next;
+        } else {
+            head(timer) = timer.next;
+        }
+        if (timer.next != NONE) {
+            timers[timer.next].prev = timer.prev;
+        }
+    }
+
+    uint32_t offset(int64_t minute) const {
+        int64_t relative = minute - base;
+        return static_cast<uint32_t>(min<int64_t>(max<int64_t>(relative, now + 1), UINT32_MAX - 1));
+    }
+
+    // Moves every timer in a higher-level slot down to where it now belongs.
+    void cascade(int level) {
+        uint32_t index = exchange(slots[level][(now >> (SLOT_BITS * level)) & (SLOTS - 1)], NONE);
+        while (index != NONE) {
+            uint32_t next = timers[index].next;
+            link(index);
+            index = next;
+        }
+    }
+
+public:
+    explicit TimerWheel(int64_t nowMinute) : base(nowMinute) {
+        for (auto& level : slots) {
+            level.fill(NONE);
+        }
+    }
+
+    // Due times in the past fire on the next advance.
+    uint32_t schedule(int64_t dueMinute, uint32_t payload) {
+        uint32_t index;
+        if (freeHead != NONE) {
+            index = freeHead;
+            freeHead = timers[index].next;
+        } else {
+            index = static_cast<uint32_t>(timers.size());
+            timers.emplace_back();
+        }
+        timers[index].due = offset(dueMinute);
+        timers[index].payload = payload;
+        link(index);
+        live++;
+        return index;
+    }
+
+    void reschedule(uint32_t handle, int64_t dueMinute) {
+        unlink(handle);
+        timers[handle].due = offset(dueMinute);
+        link(handle);
+    }
+
+    void cancel(uint32_t handle) {
+        unlink(handle);
+        timers[handle].level = LEVELS;
+        timers[handle].next = freeHead;
+        freeHead = handle;
+        live--;
+    }
+
+    // Fires onFire(handle, payload) for every timer due at or before nowMinute, in due
+    // order minute by minute. The handle is free again once onFire returns.
+    void advance(int64_t nowMinute, const function<void(uint32_t, uint32_t)>& onFire) {
+        int64_t target = nowMinute - base;
+        while (now < target && now < UINT32_MAX - 1) {
+            ++now;
+            for (int level = 1; level < LEVELS && (now & ((1u << (SLOT_BITS * level)) - 1)) == 0; ++level) {
+                cascade(level);
+            }
+            uint32_t index = exchange(slots[0][now & (SLOTS - 1)], NONE);
+            while (index != NONE) {
+                uint32_t next = timers[index].next;
+                uint32_t payload = timers[index].payload;
+                timers[index].level = LEVELS;
+                timers[index].next = freeHead;
+                freeHead = index;
+                live--;
+                onFire(index, payload);
+                index = next;
+            }
+        }
+    }
+
+    size_t pending() const {
+        return live;
+    }
+
+    size_t memoryBytes() const {
+        return timers.capacity() * sizeof(Timer);
+    }
+};
+
+// A reminder some hours before each reservation and a no-show release once its grace
+// period has passed without a check-in, keyed by the reservation ID exactly as the book
+// stores it. Timers already due when a reservation is loaded or changed are not armed,
+// so restarting on an old book does not release its history, and a guest who has
+// checked in never gets a no-show timer again. The one exception is a reminder armed
+// when a booking is made or moved less than remindMinutesBefore ahead: it is sent within
+// the minute, unless the reservation has already started.
+class ReservationTimers {
+public:
+    enum Kind { REMINDER, NO_SHOW };
+
+    static int remindMinutesBefore; // 0 turns reminders off
+    static int noShowGraceMinutes;  // 0 turns no-show release off
+
+private:
+    struct Entry {
+        string id;
+        array<uint32_t, 2> handles; // timer per kind
+    };
+
+    TimerWheel wheel;
+    vector<Entry> entries; // a timer's payload is its entry << 1 | kind
+    vector<uint32_t> freeEntries;
+    unordered_map<string, uint32_t> entryIndex; // reservation ID -> entry
+    set<string> checkedIn;
+    uint64_t fired[2] = {0, 0};
+
+    uint32_t entryFor(const string& id) {
+        auto it = entryIndex.find(id);
+        if (it != entryIndex.end()) {
+            return it->second;
+        }
+        uint32_t entry;
+        if (!freeEntries.empty()) {
+            entry = freeEntries.back();
+            freeEntries.pop_back();
+        } else {
+            entry = static_cast<uint32_t>(entries.size());
+            entries.emplace_back();
+        }
+        entries[entry].id = id;
+        entries[entry].handles = {TimerWheel::NONE, TimerWheel::NONE};
+        entryIndex.emplace(id, entry);
+        return entry;
+    }
+
+    void setTimer(uint32_t entry, Kind kind, int64_t dueMinute, int64_t nowMinute) {
+        uint32_t& handle = entries[entry].handles[kind];
+        if (dueMinute <= nowMinute) {
+            if (handle != TimerWheel::NONE) {
+                wheel.cancel(handle);
+                handle = TimerWheel::NONE;
+            }
+        } else if (handle != TimerWheel::NONE) {
+            wheel.reschedule(handle, dueMinute);
+        } else {
+            handle = wheel.schedule(dueMinute, entry << 1 | kind);
+        }
+    }
+
+    void forgetIfIdle(uint32_t entry) {
+        Entry& slot = entries[entry];
+        if (slot.handles[REMINDER] == TimerWheel::NONE && slot.handles[NO_SHOW] == TimerWheel::NONE) {
+            entryIndex.erase(slot.id);
+            string().swap(slot.id);
+            freeEntries.push_back(entry);
+        }
+    }
+
+public:
+    explicit ReservationTimers(int64_t nowMinute) : wheel(nowMinute) {}
+
+    // Schedules, or moves, both timers for a reservation starting at startMinute. With
+    // remindLate (a booking just made or moved) a reminder whose time has already passed
+    // is brought forward to the next minute instead of being dropped.
+    void arm(const string& id, int64_t startMinute, int64_t nowMinute, bool remindLate = false) {
+        uint32_t entry = entryFor(id);
+        int64_t never = nowMinute; // a due time that is never armed
+        int64_t remindAt = remindMinutesBefore > 0 ? startMinute - remindMinutesBefore : never;
+        if (remindLate && remindMinutesBefore > 0 && startMinute > nowMinute) {
+            remindAt = max(remindAt, nowMinute + 1);
+        }
+        setTimer(entry, REMINDER, remindAt, nowMinute);
+        bool releasable = noShowGraceMinutes > 0 && !checkedIn.count(id);
+        setTimer(entry, NO_SHOW, releasable ? startMinute + noShowGraceMinutes : never, nowMinute);
+        forgetIfIdle(entry);
+    }
+
+    void disarm(const string& id) {
+        checkedIn.erase(id);
+        auto it = entryIndex.find(id);
+        if (it == entryIndex.end()) {
+            return;
+        }
+        uint32_t entry = it->second;
+        for (uint32_t& handle : entries[entry].handles) {
+            if (handle != TimerWheel::NONE) {
+                wheel.cancel(handle);
+                handle = TimerWheel::NONE;
+            }
+        }
+        forgetIfIdle(entry);
+    }
+
+    // The guest has arrived: only the no-show timer is dropped, and arm() leaves it off
+    // from now on.
+    bool checkIn(const string& id) {
+        checkedIn.insert(id);
+        auto it = entryIndex.find(id);
+        if (it == entryIndex.end() || entries[it->second].handles[NO_SHOW] == TimerWheel::NONE) {
+            return false;
+        }
+        uint32_t entry = it->second;
+        wheel.cancel(entries[entry].handles[NO_SHOW]);
+        entries[entry].handles[NO_SHOW] = TimerWheel::NONE;
+        forgetIfIdle(entry);
+        return true;
+    }
+
+    // Collects the timers due by nowMinute as (reservation ID, kind) pairs.
+    vector<pair<string, Kind>> due(int64_t nowMinute) {
+        vector<pair<string, Kind>> dueTimers;
+        wheel.advance(nowMinute, [&](uint32_t, uint32_t payload) {
+            uint32_t entry = payload >> 1;
+            Kind kind = static_cast<Kind>(payload & 1);
+            dueTimers.emplace_back(entries[entry].id, kind);
+            entries[entry].handles[kind] = TimerWheel::NONE;
+            forgetIfIdle(entry);
+            fired[kind]++;
+        });
+        return dueTimers;
+    }
+
+    bool isCheckedIn(const string& id) const {
+        return checkedIn.count(id) > 0;
+    }
+
+    const set<string>& checkedInIds() const {
+        return checkedIn;
+    }
+
+    size_t pending() const {
+        return wheel.pending();
+    }
+
+    uint64_t firedCount(Kind kind) const {
+        return fired[kind];
+    }
+
+    size_t memoryBytes() const {
+        size_t bytes = wheel.memoryBytes() + entries.capacity() * sizeof(Entry) + heapBytes(freeEntries)
+                       + heapBytes(entryIndex) + heapBytes(checkedIn);
+        for (const auto& entry : entries) {
+            bytes += heapBytes(entry.id);
+        }
+        return bytes;
+    }
+};
+
+int ReservationTimers::remindMinutesBefore = 24 * 60;
+int ReservationTimers::noShowGraceMinutes = 15;
+
+// -------- Instrumentation --------
+// Subsystems register a named section that writes its current numbers. The Admin menu
+// prints all sections and saves the same text to metrics.txt.
+class Instrumentation {
+private:
+    static mutex sectionsMutex;
+    static map<string, function<void(ostream&)>> sections;
+
+public:
+    static void registerSection(const string& name, function<void(ostream&)> writer) {
+        lock_guard<mutex> lock(sectionsMutex);
+        sections[name] = std::move(writer);
+    }
+
+    static void unregisterSection(const string& name) {
+        lock_guard<mutex> lock(sectionsMutex);
+        sections.erase(name);
+    }
+
+    static void report(ostream& out) {
+        lock_guard<mutex> lock(sectionsMutex);
+        for (const auto& section : sections) {
+            out << "[" << section.first << "]\n";
+            section.second(out);
+            out << "\n";
+        }
+    }
+
+    static void writeMetricsFile(const string& path = "metrics.txt") {
+        ofstream metricsFile(path);
+        if (!metricsFile.is_open()) {
+            throw ReservationException("Unable to open metrics file for writing.");
+        }
+        report(metricsFile);
+    }
+};
+
+mutex Instrumentation::sectionsMutex;
+map<string, function<void(ostream&)>> Instrumentation::sections;
+
+// -------- Request Tracing --------
+// A front-end request (an HTTP call, or a booking change made from a menu) opens a
+// TraceRequest and the stages inside it open TraceSpans. One request in every N is sampled
+// (--trace N); its spans are appended to traces.jsonl as Chrome trace events, one per line,
+// which chrome://tracing and Perfetto load as they are. With tracing off a span costs one
+// thread-local pointer check.
+string jsonEscape(const string& text) {
+    string escaped;
+    for (char c : text) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char code[8];
+                    snprintf(code, sizeof(code), "\\u%04x", c);
+                    escaped += code;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+class Tracer {
+public:
+    struct Event {
+        string name;
+        uint64_t startMicros;
+        uint64_t durationMicros;
+    };
+
+    struct Trace {
+        string id;
+        vector<Event> events;
+    };
+
+private:
+    static atomic<uint64_t> sampleEvery; // 0 when tracing is off
+    static atomic<uint64_t> requestsSeen;
+    static atomic<uint64_t> tracesWritten;
+    static atomic<uint64_t> eventsWritten;
+    static atomic<int> nextThreadNumber;
+    static mutex fileMutex;
+    static ofstream file;
+    static thread_local Trace* current;
+
+public:
+    // Starts a fresh trace file; "[" opens the array the trace viewers expect, and they
+    // accept it without the closing bracket.
+    static bool enable(uint64_t every, const string& path = "traces.jsonl") {
+        lock_guard<mutex> lock(fileMutex);
+        file.open(path, ios::trunc);
+        if (!file.is_open()) {
+            cerr << "Error: Unable to open " << path << " for tracing.\n";
+            return false;
+        }
+        file << "[\n";
+        file.flush();
+        sampleEvery = every;
+        Instrumentation::registerSection("tracing", [](ostream& out) {
+            out << "sample_every " << sampleEvery << "\n";
+            out << "requests_seen " << requestsSeen << "\n";
+            out << "traces_written " << tracesWritten << "\n";
+            out << "events_written " << eventsWritten << "\n";
+        });
+        return true;
+    }
+
+    static uint64_t nowMicros() {
+        static const auto origin = chrono::steady_clock::now();
+        return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - origin).count();
+    }
+
+    static Trace* active() {
+        return current;
+    }
+
+    // Returns a new trace for one request in every sampleEvery, else nullptr.
+    static Trace* sample() {
+        uint64_t every = sampleEvery.load(memory_order_relaxed);
+        if (every == 0 || requestsSeen.fetch_add(1, memory_order_relaxed) % every != 0) {
+            return nullptr;
+        }
+        static thread_local mt19937_64 rng(random_device{}() ^ hash<thread::id>()(this_thread::get_id()));
+        char id[17];
+        snprintf(id, sizeof(id), "%016llx", static_cast<unsigned long long>(rng()));
+        current = new Trace{id, {}};
+        return current;
+    }
+
+    static void finish(Trace* trace) {
+        static thread_local int threadNumber = ++nextThreadNumber;
+        current = nullptr;
+        ostringstream lines;
+        for (const auto& event : trace->events) {
+            lines << "{\"name\":\"" << jsonEscape(event.name) << "\",\"cat\":\"booking\",\"ph\":\"X\",\"ts\":"
+                  << event.startMicros << ",\"dur\":" << event.durationMicros << ",\"pid\":" << getpid()
+                  << ",\"tid\":" << threadNumber << ",\"args\":{\"trace\":\"" << trace->id << "\"}},\n";
+        }
+        {
+            lock_guard<mutex> lock(fileMutex);
+            file << lines.str();
+            file.flush();
+        }
+        tracesWritten++;
+        eventsWritten += trace->events.size();
+        delete trace;
+    }
+};
+
+atomic<uint64_t> Tracer::sampleEvery{0};
+atomic<uint64_t> Tracer::requestsSeen{0};
+atomic<uint64_t> Tracer::tracesWritten{0};
+atomic<uint64_t> Tracer::eventsWritten{0};
+atomic<int> Tracer::nextThreadNumber{0};
+mutex Tracer::fileMutex;
+ofstream Tracer::file;
+thread_local Tracer::Trace* Tracer::current = nullptr;
+
+// One stage of the request being traced on this thread; a no-op when there is none.
+// end() closes the span early, for stages that are not a block of their own.
+class TraceSpan {
+private:
+    Tracer::Trace* trace;
+    const char* name;
+    uint64_t start = 0;
+
+public:
+    explicit TraceSpan(const char* name) : trace(Tracer::active()), name(name) {
+        if (trace) {
+            start = Tracer::nowMicros();
+        }
+    }
+
+    ~TraceSpan() {
+        end();
+    }
+
+    void end() {
+        if (trace) {
+            trace->events.push_back({name, start, Tracer::nowMicros() - start});
+            trace = nullptr;
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+// The root of a trace. Nested inside another request (an HTTP call reaching reserveTable)
+// it is recorded as an ordinary span of the outer trace.
+class TraceRequest {
+private:
+    Tracer::Trace* trace;
+    bool owner = false;
+    string name;
+    uint64_t start = 0;
+
+public:
+    TraceRequest(const char* kind, const string& detail = "") : trace(Tracer::active()) {
+        if (!trace) {
+            trace = Tracer::sample();
+            owner = trace != nullptr;
+        }
+        if (trace) {
+            name = detail.empty() ? kind : string(kind) + " " + detail;
+            start = Tracer::nowMicros();
+        }
+    }
+
+    ~TraceRequest() {
+        if (trace) {
+            trace->events.push_back({name, start, Tracer::nowMicros() - start});
+            if (owner) {
+                Tracer::finish(trace);
+            }
+        }
+    }
+
+    TraceRequest(const TraceRequest&) = delete;
+    TraceRequest& operator=(const TraceRequest&) = delete;
+};
+
+// -------- Traffic Capture --------
+// --capture <file> records every booking and query call made on a venue: its arguments,
+// the calling thread, when it started and how long it took, and whether it threw. Calls a
+// captured call makes internally are not recorded again. Each record is appended with a
+// single write as the call returns, so a trace cut short by killing the process is still
+// readable up to its last call. --replay runs a trace against a fresh store.
+//
+// Layout: "RSVTRACE" and a version byte, then per call a varint length followed by the op,
+// an ok byte, thread number, start (microseconds since capture began), duration, venue and
+// the op's arguments. Strings are a varint length and bytes; integers are zigzag varints.
+class TrafficCapture {
+public:
+    enum Op : uint8_t {
+        RESERVE = 1, UPDATE, CANCEL, GET, FIND_BY_PHONE, SEARCH_BY_NAME, BETWEEN, DAY_SHEET,
+        CUSTOMER_RESERVATIONS, HAS_RESERVATIONS, AVAILABILITY, HEATMAP, ALL_RESERVATIONS, VIEW_LOGS, OP_END
+    };
+
+    struct Record {
+        Op op;
+        bool ok;
+        uint32_t thread;
+        uint64_t startMicros;
+        uint64_t durationMicros;
+        string venue;
+        vector<string> strings; // arguments in call order, split by type
+        vector<int64_t> ints;
+    };
+
+private:
+    static const char MAGIC[8];
+    static const uint8_t VERSION = 1;
+    static atomic<int> fd; // -1 when capture is off
+    static atomic<uint64_t> recordsWritten;
+    static atomic<uint64_t> bytesWritten;
+    static atomic<uint32_t> nextThreadNumber;
+    static chrono::steady_clock::time_point origin;
+
+    static bool readVarint(const string& data, size_t& pos, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && pos < data.size(); shift += 7) {
+            uint8_t byte = data[pos++];
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool readString(const string& data, size_t& pos, string& value) {
+        uint64_t length;
+        if (!readVarint(data, pos, length) || length > data.size() - pos) {
+            return false;
+        }
+        value = data.substr(pos, length);
+        pos += length;
+        return true;
+    }
+
+public:
+    // Argument types per op, 's' for a string and 'i' for an integer.
+    static const char* signature(Op op) {
+        static const char* signatures[OP_END] = {
+            "", "ssissi", "sssssissi", "ss", "s", "s", "si", "ss", "s", "s", "s", "", "s", "", ""};
+        return op > 0 && op < OP_END ? signatures[op] : nullptr;
+    }
+
+    static const char* opName(Op op) {
+        static const char* names[OP_END] = {
+            "", "reserve", "update", "cancel", "get", "find_by_phone", "search_by_name", "between", "day_sheet",
+            "customer_reservations", "has_reservations", "availability", "heatmap", "all_reservations", "view_logs"};
+        return op > 0 && op < OP_END ? names[op] : "unknown";
+    }
+
+    static void appendVarint(string& out, uint64_t value) {
+        while (value >= 0x80) {
+            out += static_cast<char>(value | 0x80);
+            value >>= 7;
+        }
+        out += static_cast<char>(value);
+    }
+
+    static void appendString(string& out, const string& value) {
+        appendVarint(out, value.size());
+        out += value;
+    }
+
+    static void appendInt(string& out, int64_t value) {
+        appendVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    static bool enable(const string& path) {
+        int file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+        if (file < 0) {
+            cerr << "Error: Unable to open " << path << " for capture.\n";
+            return false;
+        }
+        string header(MAGIC, sizeof(MAGIC));
+        header += static_cast<char>(VERSION);
+        if (::write(file, header.data(), header.size()) != static_cast<ssize_t>(header.size())) {
+            ::close(file);
+            cerr << "Error: Unable to write " << path << ".\n";
+            return false;
+        }
+        origin = chrono::steady_clock::now();
+        fd = file;
+        Instrumentation::registerSection("capture", [](ostream& out) {
+            out << "records_written " << recordsWritten << "\n";
+            out << "bytes_written " << bytesWritten << "\n";
+        });
+        return true;
+    }
+
+    static bool enabled() {
+        return fd.load(memory_order_relaxed) >= 0;
+    }
+
+    static uint64_t nowMicros() {
+        return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - origin).count();
+    }
+
+    static uint32_t threadNumber() {
+        static thread_local uint32_t number = nextThreadNumber++;
+        return number;
+    }
+
+    static void append(const string& record) {
+        string framed;
+        appendVarint(framed, record.size());
+        framed += record;
+        if (::write(fd, framed.data(), framed.size()) == static_cast<ssize_t>(framed.size())) {
+            recordsWritten++;
+            bytesWritten += framed.size();
+        }
+    }
+
+    // Reads a whole trace; a truncated last record is dropped.
+    static bool load(const string& path, vector<Record>& records, string& error) {
+        ifstream file(path, ios::binary);
+        if (!file.is_open()) {
+            error = "Unable to open " + path + ".";
+            return false;
+        }
+        stringstream contents;
+        contents << file.rdbuf();
+        string data = contents.str();
+        if (data.size() <= sizeof(MAGIC) || data.compare(0, sizeof(MAGIC), MAGIC, sizeof(MAGIC)) != 0) {
+            error = path + " is not a capture file.";
+            return false;
+        }
+        if (static_cast<uint8_t>(data[sizeof(MAGIC)]) != VERSION) {
+            error = path + " was written by an unsupported capture version.";
+            return false;
+        }
+        size_t pos = sizeof(MAGIC) + 1;
+        uint64_t length;
+        while (readVarint(data, pos, length) && length <= data.size() - pos) {
+            size_t end = pos + length;
+            string body = data.substr(pos, length);
+            pos = end;
+            size_t at = 0;
+            Record record;
+            uint64_t thread;
+            if (body.size() < 2) {
+                error = "Corrupt record in " + path + ".";
+                return false;
+            }
+            record.op = static_cast<Op>(body[at++]);
+            record.ok = body[at++] != 0;
+            const char* types = signature(record.op);
+            bool valid = types && readVarint(body, at, thread) && readVarint(body, at, record.startMicros)
+                         && readVarint(body, at, record.durationMicros) && readString(body, at, record.venue);
+            for (const char* type = types; valid && *type; ++type) {
+                if (*type == 's') {
+                    record.strings.emplace_back();
+                    valid = readString(body, at, record.strings.back());
+                } else {
+                    uint64_t zigzag;
+                    valid = readVarint(body, at, zigzag);
+                    record.ints.push_back(static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1));
+                }
+            }
+            if (!valid) {
+                error = "Corrupt record in " + path + ".";
+                return false;
+            }
+            record.thread = static_cast<uint32_t>(thread);
+            records.push_back(std::move(record));
+        }
+        return true;
+    }
+};
+
+const char TrafficCapture::MAGIC[8] = {'R', 'S', 'V', 'T', 'R', 'A', 'C', 'E'};
+atomic<int> TrafficCapture::fd{-1};
+atomic<uint64_t> TrafficCapture::recordsWritten{0};
+atomic<uint64_t> TrafficCapture::bytesWritten{0};
+atomic<uint32_t> TrafficCapture::nextThreadNumber{0};
+chrono::steady_clock::time_point TrafficCapture::origin;
+
+// One call being captured; arguments are streamed in with <<. Inert when capture is off
+// or when the call is made from inside another captured call.
+class CapturedCall {
+private:
+    static thread_local int depth;
+    bool active;
+    TrafficCapture::Op op;
+    const string& venue;
+    string arguments;
+    uint64_t start = 0;
+    int exceptionsAtStart = 0;
+
+public:
+    CapturedCall(TrafficCapture::Op op, const string& venue)
+        : active(depth++ == 0 && TrafficCapture::enabled()), op(op), venue(venue) {
+        if (active) {
+            start = TrafficCapture::nowMicros();
+            exceptionsAtStart = uncaught_exceptions();
+        }
+    }
+
+    ~CapturedCall() {
+        --depth;
+        if (active) {
+            uint64_t duration = TrafficCapture::nowMicros() - start;
+            string record;
+            record += static_cast<char>(op);
+            record += static_cast<char>(uncaught_exceptions() == exceptionsAtStart);
+            TrafficCapture::appendVarint(record, TrafficCapture::threadNumber());
+            TrafficCapture::appendVarint(record, start);
+            TrafficCapture::appendVarint(record, duration);
+            TrafficCapture::appendString(record, venue);
+            record += arguments;
+            TrafficCapture::append(record);
+        }
+    }
+
+    CapturedCall& operator<<(const string& value) {
+        if (active) {
+            TrafficCapture::appendString(arguments, value);
+        }
+        return *this;
+    }
+
+    CapturedCall& operator<<(long long value) {
+        if (active) {
+            TrafficCapture::appendInt(arguments, value);
+        }
+        return *this;
+    }
+
+    CapturedCall(const CapturedCall&) = delete;
+    CapturedCall& operator=(const CapturedCall&) = delete;
+};
+
+thread_local int CapturedCall::depth = 0;
+
+// -------- Work-Stealing Task Scheduler --------
+enum class TaskPriority { FOREGROUND, MAINTENANCE };
+
+// Each worker owns a deque per priority. Workers run their own newest task first and
+// steal the oldest task from another worker when they run dry. Foreground work is always
+// taken before maintenance, and at most workers - 1 maintenance tasks run at once, so one
+// worker is always left for foreground work.
+class WorkStealingPool {
+private:
+    struct QueuedTask {
+        function<void()> run;
+        chrono::steady_clock::time_point queuedAt;
+    };
+    struct Worker {
+        mutex queueMutex;
+        deque<QueuedTask> queues[2];
+    };
+    struct LatencyStats {
+        atomic<long> completed{0};
+        atomic<long> totalWaitMicros{0};
+        atomic<long> maxWaitMicros{0};
+        atomic<long> totalRunMicros{0};
+    };
+
+    vector<unique_ptr<Worker>> workers;
+    vector<thread> threads;
+    mutex wakeMutex;
+    condition_variable wake;
+    condition_variable idle;
+    atomic<bool> stopping{false};
+    atomic<long> queued[2];
+    atomic<long> unfinished{0}; // submitted and not yet run to completion
+    atomic<int> maintenanceRunning{0};
+    atomic<unsigned> nextWorker{0};
+    LatencyStats stats[2];
+    static thread_local int currentWorker;
+
+    static int index(TaskPriority priority) {
+        return priority == TaskPriority::FOREGROUND ? 0 : 1;
+    }
+
+    bool popOwn(int self, int level, QueuedTask& task) {
+        Worker& worker = *workers[self];
+        lock_guard<mutex> lock(worker.queueMutex);
+        if (worker.queues[level].empty()) {
+            return false;
+        }
+        task = std::move(worker.queues[level].back());
+        worker.queues[level].pop_back();
+        queued[level]--;
+        return true;
+    }
+
+    bool steal(int self, int level, QueuedTask& task) {
+        for (size_t offset = 1; offset < workers.size(); ++offset) {
+            Worker& victim = *workers[(self + offset) % workers.size()];
+            lock_guard<mutex> lock(victim.queueMutex);
+            if (!victim.queues[level].empty()) {
+                task = std::move(victim.queues[level].front());
+                victim.queues[level].pop_front();
+                queued[level]--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool takeTask(int self, int& level, QueuedTask& task) {
+        for (level = 0; level < 2; ++level) {
+            if (level == 1 && maintenanceRunning.load() >= max(1, static_cast<int>(workers.size()) - 1)) {
+                return false;
+            }
+            if (queued[level].load() > 0 && (popOwn(self, level, task) || steal(self, level, task))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static void recordMax(atomic<long>& maximum, long value) {
+        long current = maximum.load();
+        while (value > current && !maximum.compare_exchange_weak(current, value)) {
+        }
+    }
+
+    void workerLoop(int self) {
+        currentWorker = self;
+        while (true) {
+            QueuedTask task;
+            int level;
+            if (!takeTask(self, level, task)) {
+                unique_lock<mutex> lock(wakeMutex);
+                if (stopping && queued[0] == 0 && queued[1] == 0) {
+                    return;
+                }
+                wake.wait_for(lock, chrono::milliseconds(50));
+                continue;
+            }
+            if (level == 1) {
+                maintenanceRunning++;
+            }
+            auto started = chrono::steady_clock::now();
+            try {
+                task.run();
+            } catch (const exception& ex) {
+                cerr << "Background task failed: " << ex.what() << "\n";
+            }
+            auto finished = chrono::steady_clock::now();
+            if (level == 1) {
+                maintenanceRunning--;
+                wake.notify_one();
+            }
+            long waitMicros = chrono::duration_cast<chrono::microseconds>(started - task.queuedAt).count();
+            stats[level].completed++;
+            stats[level].totalWaitMicros += waitMicros;
+            stats[level].totalRunMicros += chrono::duration_cast<chrono::microseconds>(finished - started).count();
+            recordMax(stats[level].maxWaitMicros, waitMicros);
+            if (--unfinished == 0) {
+                lock_guard<mutex> lock(wakeMutex);
+                idle.notify_all();
+            }
+        }
+    }
+
+public:
+    explicit WorkStealingPool(int workerCount) {
+        queued[0] = queued[1] = 0;
+        for (int i = 0; i < workerCount; ++i) {
+            workers.emplace_back(new Worker());
+        }
+        for (int i = 0; i < workerCount; ++i) {
+            threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            lock_guard<mutex> lock(wakeMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : threads) {
+            worker.join();
+        }
+    }
+
+    // Called from a worker, the task goes on that worker's own deque; otherwise the
+    // workers take turns.
+    void submit(TaskPriority priority, function<void()> run) {
+        unfinished++;
+        int level = index(priority);
+        int target = currentWorker >= 0 ? currentWorker : static_cast<int>(nextWorker++ % workers.size());
+        {
+            lock_guard<mutex> lock(workers[target]->queueMutex);
+            queued[level]++;
+            workers[target]->queues[level].push_back({std::move(run), chrono::steady_clock::now()});
+        }
+        lock_guard<mutex> lock(wakeMutex);
+        wake.notify_one();
+    }
+
+    // Blocks until every task submitted so far, and any it submitted in turn, has run.
+    // Not for use from a worker.
+    void waitIdle() {
+        unique_lock<mutex> lock(wakeMutex);
+        idle.wait(lock, [this] { return unfinished.load() == 0; });
+    }
+
+    long queueDepth(TaskPriority priority) const {
+        return queued[index(priority)].load();
+    }
+
+    void writeMetrics(ostream& out) const {
+        out << "workers " << workers.size() << "\n";
+        const char* names[2] = {"foreground", "maintenance"};
+        for (int level = 0; level < 2; ++level) {
+            long completed = stats[level].completed.load();
+            out << names[level] << ".queue_depth " << queued[level].load() << "\n"
+                << names[level] << ".completed " << completed << "\n"
+                << names[level] << ".avg_wait_us " << (completed ? stats[level].totalWaitMicros.load() / completed : 0) << "\n"
+                << names[level] << ".max_wait_us " << stats[level].maxWaitMicros.load() << "\n"
+                << names[level] << ".avg_run_us " << (completed ? stats[level].totalRunMicros.load() / completed : 0) << "\n";
+        }
+    }
+};
+
+thread_local int WorkStealingPool::currentWorker = -1;
+
+// -------- Mutation Journal --------
+// Every committed reserve, cancel or update is also described as one journal record, so
+// another copy of the book can replay it. On the wire a record is a single line:
+// M|seq|commit-us|venue|op|next-id|old-id|<reservation as in reservations.txt>
+struct MutationRecord {
+    enum Op : char { RESERVE = 'R', CANCEL = 'C', UPDATE = 'U' };
+
+    uint64_t seq = 0;
+    int64_t commitMicros = 0; // wall clock, so a standby on the same host can measure lag
+    string venue;
+    Op op = RESERVE;
+    int nextReservationId = 1;
+    string oldId; // reservation replaced or removed (cancel, update)
+    Reservation reservation{"", "", "", 0, "", "", -1};
+
+    static int64_t nowMicros() {
+        return chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    string serialize() const {
+        ostringstream out;
+        out << "M|" << seq << "|" << commitMicros << "|" << venue << "|" << static_cast<char>(op) << "|"
+            << nextReservationId << "|" << oldId << "|" << reservation.id << "|" << reservation.customerName << "|"
+            << reservation.phoneNumber << "|" << reservation.partySize << "|" << reservation.date << "|"
+            << reservation.time << "|" << reservation.tableNumber;
+        return out.str();
+    }
+
+    static bool parse(const string& line, MutationRecord& record) {
+        vector<string> fields;
+        stringstream ss(line);
+        string field;
+        while (getline(ss, field, '|')) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 14 || fields[0] != "M" || fields[4].size() != 1) {
+            return false;
+        }
+        try {
+            record.seq = stoull(fields[1]);
+            record.commitMicros = stoll(fields[2]);
+            record.venue = fields[3];
+            record.op = static_cast<Op>(fields[4][0]);
+            record.nextReservationId = stoi(fields[5]);
+            record.oldId = fields[6];
+            record.reservation = Reservation(fields[7], fields[8], fields[9], stoi(fields[10]), fields[11], fields[12],
+                                             stoi(fields[13]));
+        } catch (...) {
+            return false;
+        }
+        return record.op == RESERVE || record.op == CANCEL || record.op == UPDATE;
+    }
+};
+
+// -------- Lock Contention Profiler --------
+// Opt-in with --lock-profile. Every place that takes a profiled lock is a site; each site
+// keeps log2 histograms of how long it waited for the lock and how long it held it, and,
+// for every wait, which site was holding the lock at the time. With profiling off a
+// profiled lock costs one relaxed load on top of the lock itself.
+class LockProfiler {
+public:
+    static const int BUCKETS = 40; // bucket b counts durations in [2^(b-1), 2^b) ns
+
+    struct Site {
+        const char* lockName;
+        const char* file;
+        unsigned line;
+        string function;
+        atomic<uint64_t> acquisitions{0};
+        atomic<uint64_t> contended{0};
+        atomic<uint64_t> waitNanos{0};
+        atomic<uint64_t> holdNanos{0};
+        array<atomic<uint64_t>, BUCKETS> waitHistogram{};
+        array<atomic<uint64_t>, BUCKETS> holdHistogram{};
+        mutex blockersMutex;
+        map<const Site*, uint64_t> blockedBy; // holder site -> waits behind it (nullptr: unknown)
+
+        Site(const char* lockName, const char* file, unsigned line, const string& function)
+            : lockName(lockName), file(file), line(line), function(function) {}
+    };
+
+private:
+    static atomic<bool> enabled;
+    static mutex sitesMutex;
+    static vector<unique_ptr<Site>> sites;
+
+    static int bucket(uint64_t nanos) {
+        return nanos ? min(BUCKETS - 1, 64 - __builtin_clzll(nanos)) : 0;
+    }
+
+    // Upper bound of the bucket holding the p-th quantile.
+    static uint64_t quantile(const array<atomic<uint64_t>, BUCKETS>& histogram, double p) {
+        uint64_t total = 0;
+        for (const auto& count : histogram) {
+            total += count;
+        }
+        uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; ++b) {
+            seen += histogram[b];
+            if (total && seen >= p * total) {
+                return b ? 1ULL << b : 0;
+            }
+        }
+        return 0;
+    }
+
+    static string describe(const Site* site) {
+        if (!site) {
+            return "unknown holder";
+        }
+        string file = site->file;
+        return file.substr(file.find_last_of('/') + 1) + ":" + to_string(site->line) + " " + site->function;
+    }
+
+public:
+    static void enable() {
+        enabled = true;
+        Instrumentation::registerSection("locks", [](ostream& out) { report(out, 10); });
+    }
+
+    static bool isEnabled() {
+        return enabled.load(memory_order_relaxed);
+    }
+
+    static Site* site(const char* lockName, const source_location& location) {
+        thread_local map<tuple<const char*, const char*, unsigned>, Site*> cache;
+        auto key = make_tuple(lockName, location.file_name(), location.line());
+        auto cached = cache.find(key);
+        if (cached != cache.end()) {
+            return cached->second;
+        }
+        lock_guard<mutex> lock(sitesMutex);
+        for (const auto& existing : sites) {
+            if (existing->lockName == lockName && existing->file == location.file_name() && existing->line == location.line()) {
+                return cache[key] = existing.get();
+            }
+        }
+        string function = location.function_name();
+        function = function.substr(0, function.find('('));
+        function = function.substr(function.find_last_of(' ') + 1);
+        sites.emplace_back(new Site(lockName, location.file_name(), location.line(), function));
+        return cache[key] = sites.back().get();
+    }
+
+    static void recordAcquire(Site& site, bool contended, uint64_t waitNanos, const Site* holder) {
+        site.acquisitions.fetch_add(1, memory_order_relaxed);
+        site.waitHistogram[bucket(waitNanos)].fetch_add(1, memory_order_relaxed);
+        if (contended) {
+            site.contended.fetch_add(1, memory_order_relaxed);
+            site.waitNanos.fetch_add(waitNanos, memory_order_relaxed);
+            lock_guard<mutex> lock(site.blockersMutex);
+            site.blockedBy[holder]++;
+        }
+    }
+
+    static void recordRelease(Site& site, uint64_t holdNanos) {
+        site.holdNanos.fetch_add(holdNanos, memory_order_relaxed);
+        site.holdHistogram[bucket(holdNanos)].fetch_add(1, memory_order_relaxed);
+    }
+
+    // The top sites by total time spent waiting.
+    static void report(ostream& out, size_t top) {
+        if (!isEnabled()) {
+            out << "Lock profiling is off (start with --lock-profile).\n";
+            return;
+        }
+        lock_guard<mutex> lock(sitesMutex);
+        vector<Site*> ranked;
+        for (const auto& site : sites) {
+            ranked.push_back(site.get());
+        }
+        sort(ranked.begin(), ranked.end(), [](const Site* a, const Site* b) { return a->waitNanos > b->waitNanos; });
+        if (ranked.size() > top) {
+            ranked.resize(top);
+        }
+        for (Site* site : ranked) {
+            uint64_t acquisitions = site->acquisitions;
+            out << site->lockName << " @ " << describe(site) << "\n";
+            out << "  acquisitions " << acquisitions << ", contended " << site->contended << " ("
+                << (acquisitions ? site->contended * 100 / acquisitions : 0) << "%), waited "
+                << site->waitNanos / 1000 << "us, held " << site->holdNanos / 1000 << "us\n";
+            out << "  wait p50 <= " << quantile(site->waitHistogram, 0.5) << "ns, p99 <= "
+                << quantile(site->waitHistogram, 0.99) << "ns; hold p50 <= " << quantile(site->holdHistogram, 0.5)
+                << "ns, p99 <= " << quantile(site->holdHistogram, 0.99) << "ns\n";
+            lock_guard<mutex> blockersLock(site->blockersMutex);
+            for (const auto& blocker : site->blockedBy) {
+                out << "  waited behind " << describe(blocker.first) << " x" << blocker.second << "\n";
+            }
+        }
+        if (ranked.empty()) {
+            out << "No profiled locks taken yet.\n";
+        }
+    }
+};
+
+atomic<bool> LockProfiler::enabled{false};
+mutex LockProfiler::sitesMutex;
+vector<unique_ptr<LockProfiler::Site>> LockProfiler::sites;
+
+// A mutex that remembers which site holds it, so a waiter can blame it.
+template <class Mutex>
+struct ProfiledMutex {
+    Mutex mutex;
+    const char* name;
+    atomic<LockProfiler::Site*> holder{nullptr};
+
+    explicit ProfiledMutex(const char* lockName) : name(lockName) {}
+};
+
+// Scoped lock on a ProfiledMutex; the site is wherever the lock is constructed. For a
+// recursive mutex only the outermost hold is timed.
+template <class Mutex>
+class ProfiledLock {
+private:
+    ProfiledMutex<Mutex>& target;
+    LockProfiler::Site* site = nullptr; // null when profiling was off at acquisition
+    bool outermost = false;
+    chrono::steady_clock::time_point acquiredAt;
+
+public:
+    explicit ProfiledLock(ProfiledMutex<Mutex>& lockTarget, const source_location& location = source_location::current())
+        : target(lockTarget) {
+        if (!LockProfiler::isEnabled()) {
+            target.mutex.lock();
+            return;
+        }
+        site = LockProfiler::site(target.name, location);
+        uint64_t waitNanos = 0;
+        bool contended = !target.mutex.try_lock();
+        const LockProfiler::Site* holder = nullptr;
+        if (contended) {
+            holder = target.holder.load(memory_order_relaxed);
+            auto start = chrono::steady_clock::now();
+            target.mutex.lock();
+            waitNanos = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        }
+        if (!target.holder.load(memory_order_relaxed)) {
+            target.holder.store(site, memory_order_relaxed);
+            outermost = true;
+        }
+        LockProfiler::recordAcquire(*site, contended, waitNanos, holder);
+        acquiredAt = chrono::steady_clock::now();
+    }
+
+    ~ProfiledLock() {
+        if (site && outermost) {
+            LockProfiler::recordRelease(
+                *site, chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - acquiredAt).count());
+            target.holder.store(nullptr, memory_order_relaxed);
+        }
+        target.mutex.unlock();
+    }
+
+    ProfiledLock(const ProfiledLock&) = delete;
+    ProfiledLock& operator=(const ProfiledLock&) = delete;
+};
+
+// Exclusive use of one shard for the rest of a statement, e.g. venue()->reserveTable(...).
+// Console and socket sessions, HTTP workers and replication all go through this.
+template <class Shard>
+class ShardAccess {
+private:
+    ProfiledLock<recursive_mutex> lock;
+    Shard* shard;
+
+public:
+    ShardAccess(ProfiledMutex<recursive_mutex>& mutex, Shard* target, const source_location& site)
+        : lock(mutex, site), shard(target) {}
+    Shard* operator->() const { return shard; }
+    Shard& operator*() const { return *shard; }
+};
+
+// -------- Reservation Manager (one per venue shard) --------
+class ReservationManager {
+private:
+    vector<bool> tables;    // true while no live reservation holds the table; follows liveHolds
+    vector<Reservation> reservations;
+    string venueId;
+    string storageDir; // prefix for this venue's files; empty for the default venue
+    int nextReservationId;
+    unordered_map<string, size_t> idIndex; // reservation ID -> position in reservations
+    PhoneIndex phoneIndex;
+    NameSearchIndex nameIndex;
+    ScheduleIndex scheduleIndex;
+    mutable AvailabilityHeatmap<10> heatmap; // per-date cache, filled on first view
+    SlotClaimBoard slotClaims;
+    ExpiryWheel expiry;     // releases a table once the last reservation holding it has ended
+    vector<int> liveHolds;  // per table, reservations on it that have not ended yet
+    ReservationTimers timers; // reminders and no-show releases
+    int mutationsSinceMaintenance = 0;
+    uint64_t maintenanceRuns = 0;
+    WorkStealingPool& scheduler;
+    bool persistent; // false for standby copies, which keep the book in memory only
+    atomic<bool> readOnly{false}; // read outside the shard lock by reserveTable
+    function<void(const MutationRecord&)> mutationListener;
+    mutable ProfiledMutex<recursive_mutex> stateMutex{"venue shard"};
+
+    static const int MAINTENANCE_INTERVAL = 20; // mutations between automatic maintenance runs
+
+    // Shared with the maintenance tasks. fileMutex is held while reservations.txt is written
+    // or scrubbed, so a scrub never reads a half-written file, and it checks the file
+    // against what was last written (or read at startup). runMutex lets one snapshot or
+    // report write at a time, and a run never overwrites the output of a later one.
+    struct MaintenanceState {
+        mutex fileMutex;
+        bool written = false;
+        uint64_t writtenChecksum = 0;
+        mutex runMutex;
+        uint64_t snapshotRun = 0;
+        uint64_t reportRun = 0;
+    };
+    shared_ptr<MaintenanceState> maintenance = make_shared<MaintenanceState>();
+
+    string path(const string& file) const {
+        return storageDir + file;
+    }
+
+    // Serialized exactly as reservations.txt stores them.
+    static string serializeReservations(const vector<Reservation>& list) {
+        ostringstream out;
+        for (const auto& res : list) {
+            out << res.id << "|" << res.customerName << "|" << res.phoneNumber << "|"
+                << res.partySize << "|" << res.date << "|" << res.time << "|"
+                << res.tableNumber << "\n";
+        }
+        return out.str();
+    }
+
+    static uint64_t checksum(const string& data) {
+        uint64_t hash = 1469598103934665603ULL; // FNV-1a
+        for (unsigned char c : data) {
+            hash = (hash ^ c) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    void requireWritable() const {
+        if (readOnly) {
+            throw ReservationException("This server is a read-only standby.");
+        }
+    }
+
+    void publishMutation(MutationRecord::Op op, const string& oldId, const Reservation& res) {
+        if (!mutationListener) {
+            return;
+        }
+        MutationRecord record;
+        record.commitMicros = MutationRecord::nowMicros();
+        record.venue = venueId;
+        record.op = op;
+        record.nextReservationId = nextReservationId;
+        record.oldId = oldId;
+        record.reservation = res;
+        mutationListener(record);
+    }
+
+    void noteMutation() {
+        if (++mutationsSinceMaintenance >= MAINTENANCE_INTERVAL) {
+            scheduleMaintenance();
+        }
+    }
+
+    string getCurrentTimestamp() {
+        ClockReading now = Clock::read();
+        return now.date + " " + now.timeText() + ":00";
+    }
+
+    // Called after reservations[pos] is appended or changed in place.
+    void indexReservation(size_t pos, bool remindLate = false) {
+        const Reservation& res = reservations[pos];
+        idIndex[res.id] = pos;
+        phoneIndex.add(res.phoneNumber, res.id);
+        nameIndex.add(res.customerName, res.id);
+        scheduleIndex.add(res);
+        heatmap.add(res);
+        int64_t start;
+        if (!Clock::parseInstant(res.date + " " + res.time, start)) {
+            return;
+        }
+        if (res.tableNumber >= 0 && res.tableNumber < static_cast<int>(tables.size())) {
+            if (expiry.cancel(res.id) < 0) {
+                liveHolds[res.tableNumber]++;
+            }
+            tables[res.tableNumber] = false;
+            expiry.schedule(res.id, res.tableNumber, start + RESERVATION_SLOTS * SLOT_MINUTES);
+        }
+        timers.arm(res.id, start, Clock::nowMinutes(), remindLate); // moves the timers if already armed
+    }
+
+    void unindexReservation(const Reservation& res) {
+        idIndex.erase(res.id);
+        phoneIndex.remove(res.phoneNumber, res.id);
+        nameIndex.remove(res.customerName, res.id);
+        scheduleIndex.remove(res);
+        heatmap.remove(res);
+        int table = expiry.cancel(res.id);
+        if (table >= 0) {
+            tables[table] = --liveHolds[table] == 0;
+        }
+    }
+
+    // Timers stay armed across unindex/index, so an update reschedules them in place;
+    // only removing a reservation or changing its ID drops them.
+    void dropTimers(const string& id) {
+        bool wasCheckedIn = timers.isCheckedIn(id);
+        timers.disarm(id);
+        if (wasCheckedIn) {
+            saveCheckIns();
+        }
+    }
+
+    // checkins.txt lists the reservations whose guests have arrived, one ID per line, so
+    // a restart does not arm no-show releases for them again.
+    void saveCheckIns() {
+        if (!persistent) {
+            return;
+        }
+        ofstream checkInFile(path("checkins.txt"));
+        if (!checkInFile.is_open()) {
+            throw ReservationException("Unable to open check-ins file for writing.");
+        }
+        for (const string& id : timers.checkedInIds()) {
+            checkInFile << id << "\n";
+        }
+    }
+
+    void loadCheckIns() {
+        ifstream checkInFile(path("checkins.txt"));
+        string id;
+        while (getline(checkInFile, id)) {
+            if (!id.empty()) {
+                timers.checkIn(id);
+            }
+        }
+    }
+
+    void appendOutbox(const string& messages) {
+        if (!persistent || messages.empty()) {
+            return;
+        }
+        ofstream outbox(path("outbox.txt"), ios::app);
+        if (!outbox.is_open()) {
+            throw ReservationException("Unable to open outbox file.");
+        }
+        outbox << messages;
+    }
+
+    // A no-show is cancelled like any other reservation, but logged as the system's doing.
+    void releaseNoShow(const Reservation& res) {
+        slotClaims.release(res.date, res.time, res.tableNumber);
+        size_t pos = idIndex.at(res.id);
+        unindexReservation(reservations[pos]);
+        dropTimers(res.id);
+        reservations.erase(reservations.begin() + pos);
+        reindexPositionsFrom(pos);
+        saveReservations();
+        publishMutation(MutationRecord::CANCEL, res.id, res);
+        noteMutation();
+        logReservationAction("System", "timers", "Released no-show", "ID " + res.id, res.id, res.customerName,
+                             res.phoneNumber, res.partySize, res.date, res.time, res.tableNumber);
+    }
+
+    // Frees each table whose last live reservation has ended by now on the clock.
+    void releaseExpired() {
+        expiry.advance(Clock::nowMinutes(), [this](const string&, int table) {
+            if (--liveHolds[table] == 0) {
+                tables[table] = true;
+            }
+        });
+    }
+
+    // Erasing from the middle of reservations shifts everything after it.
+    void reindexPositionsFrom(size_t pos) {
+        for (size_t i = pos; i < reservations.size(); ++i) {
+            idIndex[reservations[i].id] = i;
+        }
+    }
+
+    void writeLogToFile(const string& logEntry) {
+        USDT_SCOPE(write_log_to_file, venueId.c_str(), logEntry.size());
+        if (!persistent) {
+            return;
+        }
+        TraceSpan span("writeLogToFile");
+        ofstream logFile(path("logs.txt"), ios::app);
+        if (logFile.is_open()) {
+            logFile << logEntry << "\n\n";
+            logFile.close();
+        } else {
+            throw ReservationException("Unable to open log file.");
+        }
+    }
+
+    void saveReservations() {
+        USDT_SCOPE(save_reservations, venueId.c_str(), reservations.size());
+        if (!persistent) {
+            return;
+        }
+        TraceSpan span("saveReservations");
+        string data = serializeReservations(reservations);
+        {
+            lock_guard<mutex> lock(maintenance->fileMutex);
+            ofstream resFile(path("reservations.txt"));
+            if (!resFile.is_open()) {
+                throw ReservationException("Unable to open reservations file for writing.");
+            }
+            resFile << data;
+            resFile.close();
+            maintenance->written = true;
+            maintenance->writtenChecksum = checksum(data);
+        }
+
+        ofstream idFile(path("next_id.txt"));
+        if (!idFile.is_open()) {
+            throw ReservationException("Unable to open next_id file for writing.");
+        }
+        idFile << nextReservationId << "\n";
+        idFile.close();
+    }
+
+    void loadReservations() {
+        USDT_SCOPE(load_reservations, venueId.c_str());
+        ifstream resFile(path("reservations.txt"));
+        if (resFile.is_open()) {
+            stringstream contents;
+            contents << resFile.rdbuf();
+            resFile.close();
+            maintenance->written = true;
+            maintenance->writtenChecksum = checksum(contents.str());
+            string line;
+            int overlapping = 0;
+            while (getline(contents, line)) {
+                stringstream ss(line);
+                string id, customerName, phoneNumber, date, time;
+                int partySize, tableNumber;
+                getline(ss, id, '|');
+                getline(ss, customerName, '|');
+                getline(ss, phoneNumber, '|');
+                ss >> partySize;
+                ss.ignore(1);
+                getline(ss, date, '|');
+                getline(ss, time, '|');
+                ss >> tableNumber;
+
+                // A record that overlaps an earlier one on the same table is dropped; the
+                // first one read keeps the slots.
+                int64_t firstSlot;
+                if (tableNumber >= 0 && tableNumber < static_cast<int>(tables.size())
+                    && SlotClaimBoard::windowStart(date, time, firstSlot) && !slotClaims.claim(date, time, tableNumber)) {
+                    overlapping++;
+                    continue;
+                }
+                reservations.emplace_back(id, customerName, phoneNumber, partySize, date, time, tableNumber);
+                indexReservation(reservations.size() - 1);
+
+                if (validateReservationId(id)) {
+                    string numStr = id.substr(3, id.length() - 4);
+                    try {
+                        int idNum = stoi(numStr);
+                        nextReservationId = max(nextReservationId, idNum + 1);
+                    } catch (...) {
+                    }
+                }
+            }
+            if (overlapping > 0) {
+                cerr << "Warning: Skipped " << overlapping << " reservations in " << path("reservations.txt")
+                     << " that overlap an earlier one on the same table.\n";
+            }
+        }
+
+        ifstream idFile(path("next_id.txt"));
+        if (idFile.is_open()) {
+            int savedId;
+            if (idFile >> savedId) {
+                nextReservationId = max(nextReservationId, savedId);
+            }
+            idFile.close();
+        }
+    }
+
+public:
+    // The default venue keeps the original files in the working directory; every other
+    // venue gets its own directory under venues/.
+    // A standby copy starts empty and read-only and is filled by applyMutation().
+    ReservationManager(const string& venue, bool isDefaultVenue, WorkStealingPool& pool, bool isStandby = false)
+        : tables(10, true), venueId(venue), storageDir(isDefaultVenue ? "" : "venues/" + venue + "/"),
+          nextReservationId(1), slotClaims(10), expiry(Clock::nowMinutes()),
+          liveHolds(10, 0), timers(Clock::nowMinutes()), scheduler(pool), persistent(!isStandby),
+          readOnly(isStandby) {
+        if (persistent) {
+            if (!storageDir.empty()) {
+                filesystem::create_directories(storageDir);
+            }
+            loadCheckIns();
+            loadReservations();
+            releaseExpired();
+        }
+    }
+
+    ShardAccess<ReservationManager> access(const source_location& site = source_location::current()) {
+        return ShardAccess<ReservationManager>(stateMutex, this, site);
+    }
+
+    ShardAccess<const ReservationManager> access(const source_location& site = source_location::current()) const {
+        return ShardAccess<const ReservationManager>(stateMutex, this, site);
+    }
+
+    const string& getVenueId() const {
+        return venueId;
+    }
+
+    int getNextReservationId() const {
+        return nextReservationId;
+    }
+
+    void restoreNextReservationId(int id) {
+        nextReservationId = max(nextReservationId, id);
+    }
+
+    void setMutationListener(function<void(const MutationRecord&)> listener) {
+        mutationListener = std::move(listener);
+    }
+
+    // Replays a record committed elsewhere. The primary already validated it, so this
+    // only moves the table, slot and index state along.
+    void applyMutation(const MutationRecord& record) {
+        auto it = idIndex.find(record.oldId);
+        if (record.op != MutationRecord::RESERVE && it != idIndex.end()) {
+            size_t pos = it->second;
+            Reservation& old = reservations[pos];
+            slotClaims.release(old.date, old.time, old.tableNumber);
+            unindexReservation(old);
+            if (record.op == MutationRecord::CANCEL || old.id != record.reservation.id) {
+                dropTimers(old.id);
+            }
+            if (record.op == MutationRecord::UPDATE) {
+                old = record.reservation;
+                indexReservation(pos);
+            } else {
+                reservations.erase(reservations.begin() + pos);
+                reindexPositionsFrom(pos);
+            }
+        } else if (record.op != MutationRecord::CANCEL) {
+            reservations.push_back(record.reservation);
+            indexReservation(reservations.size() - 1);
+        }
+        const Reservation& res = record.reservation;
+        if (record.op != MutationRecord::CANCEL) {
+            slotClaims.claim(res.date, res.time, res.tableNumber);
+        }
+        nextReservationId = max(nextReservationId, record.nextReservationId);
+        saveReservations();
+    }
+
+    // Turns a standby copy into the primary: it writes the book it has replayed to this
+    // venue's files and starts accepting changes.
+    void promote() {
+        persistent = true;
+        readOnly = false;
+        if (!storageDir.empty()) {
+            filesystem::create_directories(storageDir);
+        }
+        saveReservations();
+    }
+
+    bool reservationIdExists(const string& id, const string& excludeId = "") {
+        string upperId = toUpperCase(id);
+        string upperExcludeId = toUpperCase(excludeId);
+        return upperId != upperExcludeId && idIndex.count(upperId) > 0;
+    }
+
+    void logLogin(const string& role, const string& username, const string& password) {
+        string timestamp = getCurrentTimestamp();
+        ostringstream logEntry;
+        logEntry << "Account Log: (" << timestamp << ", N/A) | User: " << username
+                 << " | Password: " << password;
+        writeLogToFile(logEntry.str());
+    }
+
+    void logReservationAction(const string& role, const string& username, const string& action, const string& details,
+                              const string& id = "", const string& customerName = "", const string& phoneNumber = "",
+                              int partySize = 0, const string& date = "", const string& time = "", int tableNumber = -1) {
+        ostringstream logEntry;
+        logEntry << "Reservation Log\n"
+                 << "Action: " << action << " by " << role << ": " << username << "\n"
+                 << "Details: " << details;
+        if (!id.empty() || !customerName.empty() || !phoneNumber.empty() || partySize > 0 ||
+            !date.empty() || !time.empty() || tableNumber >= 0) {
+            logEntry << "\n"
+                     << "ID: " << (id.empty() ? "N/A" : id) << " | "
+                     << "Name: " << (customerName.empty() ? "N/A" : customerName) << " | "
+                     << "Contact: " << (phoneNumber.empty() ? "N/A" : phoneNumber) << " | "
+                     << "Party-Size: " << (partySize > 0 ? to_string(partySize) : "N/A") << " | "
+                     << "Date: " << (date.empty() ? "N/A" : date) << " | "
+                     << "Time: " << (time.empty() ? "N/A" : time) << " | "
+                     << "Table: " << (tableNumber >= 0 ? to_string(tableNumber + 1) : "N/A");
+        }
+        writeLogToFile(logEntry.str());
+    }
+
+    void logError(const string& role, const string& username, const string& action, const string& errorMsg,
+                  const string& id = "", const string& customerName = "", const string& phoneNumber = "",
+                  int partySize = 0, const string& date = "", const string& time = "", int tableNumber = -1) {
+        ostringstream logEntry;
+        logEntry << "Reservation Error Log\n"
+                 << "Action: " << action << " by " << role << ": " << username << "\n"
+                 << "Error: " << errorMsg;
+        if (!id.empty() || !customerName.empty() || !phoneNumber.empty() || partySize > 0 ||
+            !date.empty() || !time.empty() || tableNumber >= 0) {
+            logEntry << "\n"
+                     << "ID: " << (id.empty() ? "N/A" : id) << " | "
+                     << "Name: " << (customerName.empty() ? "N/A" : customerName) << " | "
+                     << "Contact: " << (phoneNumber.empty() ? "N/A" : phoneNumber) << " | "
+                     << "Party-Size: " << (partySize > 0 ? to_string(partySize) : "N/A") << " | "
+                     << "Date: " << (date.empty() ? "N/A" : date) << " | "
+                     << "Time: " << (time.empty() ? "N/A" : time) << " | "
+                     << "Table: " << (tableNumber >= 0 ? to_string(tableNumber + 1) : "N/A");
+        }
+        writeLogToFile(logEntry.str());
+    }
+
+    // Frees tables whose reservations have ended, then sends the reminders and releases
+    // the no-shows that are due on the clock; the messages go to outbox.txt, a stand-in
+    // for SMS. A standby copy only frees tables and leaves the rest to the primary.
+    void runDueTimers() {
+        releaseExpired();
+        if (readOnly) {
+            return;
+        }
+        vector<pair<string, ReservationTimers::Kind>> due = timers.due(Clock::nowMinutes());
+        if (due.empty()) {
+            return;
+        }
+        string stamp = getCurrentTimestamp();
+        string messages;
+        for (const auto& timer : due) {
+            auto it = idIndex.find(timer.first);
+            if (it == idIndex.end()) {
+                continue;
+            }
+            Reservation res = reservations[it->second];
+            if (timer.second == ReservationTimers::REMINDER) {
+                messages += stamp + " | SMS " + res.phoneNumber + " | Reminder: your table for " + to_string(res.partySize)
+                            + " on " + res.date + " at " + res.time + " (" + res.id + ").\n";
+            } else {
+                releaseNoShow(res);
+                messages += stamp + " | SMS " + res.phoneNumber + " | Your reservation " + res.id + " for " + res.date
+                            + " at " + res.time + " was released because you had not checked in.\n";
+            }
+        }
+        appendOutbox(messages);
+    }
+
+    // Marks the guest as arrived, which stops the no-show release. Returns false if no
+    // release was pending (already checked in, or the grace period is off).
+    bool checkIn(const string& reservationId, const string& receptionist) {
+        requireWritable();
+        string upperId = toUpperCase(reservationId);
+        auto it = idIndex.find(upperId);
+        if (it == idIndex.end()) {
+            throw ReservationException("Reservation ID not found.");
+        }
+        runDueTimers();
+        if (!idIndex.count(upperId)) {
+            throw ReservationException("Reservation was already released as a no-show.");
+        }
+        bool pending = timers.checkIn(upperId);
+        saveCheckIns();
+        const Reservation& res = reservations[idIndex.at(upperId)];
+        logReservationAction("Receptionist", receptionist, "Checked in guest", "ID " + upperId, res.id, res.customerName,
+                             res.phoneNumber, res.partySize, res.date, res.time, res.tableNumber);
+        return pending;
+    }
+
+    void writeTimerMetrics(ostream& out) const {
+        out << "venue " << venueId << ": " << timers.pending() << " timers pending, "
+            << timers.firedCount(ReservationTimers::REMINDER) << " reminders sent, "
+            << timers.firedCount(ReservationTimers::NO_SHOW) << " no-show releases\n";
+    }
+
+    void viewTableAvailability(ostream& out) {
+        CapturedCall capture(TrafficCapture::AVAILABILITY, venueId);
+        runDueTimers();
+        for (int i = 0; i < tables.size(); ++i) {
+            out << "Table " << i + 1 << " is " << (tables[i] ? "AVAILABLE" : "BOOKED") << "\n";
+        }
+    }
+
+    void viewAvailabilityHeatmap(ostream& out, const string& date) const {
+        CapturedCall capture(TrafficCapture::HEATMAP, venueId);
+        capture << date;
+        if (!heatmap.isCached(date)) {
+            heatmap.build(date, [this](const string& day) { return getDaySheet(day); });
+        }
+        out << "\n--- Table Availability for " << date << " ---\n" << heatmap.render(date);
+    }
+
+    // Whether a reservation at that date and time holds its slots on the table.
+    bool isSlotClaimed(const string& date, const string& time, int tableNumber) {
+        return slotClaims.isClaimed(date, time, tableNumber);
+    }
+
+    // Tables no live reservation holds, one bit per table.
+    vector<uint64_t> availableTablesMask() const {
+        vector<uint64_t> mask((tables.size() + 63) / 64, 0);
+        for (size_t table = 0; table < tables.size(); ++table) {
+            if (tables[table]) {
+                mask[table / 64] |= 1ULL << (table % 64);
+            }
+        }
+        return mask;
+    }
+
+    bool hasReservations(const string& customerName) {
+        CapturedCall capture(TrafficCapture::HAS_RESERVATIONS, venueId);
+        capture << customerName;
+        for (const auto& res : reservations) {
+            if (res.customerName == customerName) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    vector<Reservation> getAllReservations() const {
+        CapturedCall capture(TrafficCapture::ALL_RESERVATIONS, venueId);
+        return reservations;
+    }
+
+    size_t reservationCount() const {
+        return reservations.size();
+    }
+
+    // Estimated heap held by this shard, reported through MemoryAccounting.
+    MemoryAccounting::Footprint storeFootprint() const {
+        return {heapBytes(reservations) + tables.capacity() / 8, reservations.size()};
+    }
+
+    MemoryAccounting::Footprint indexFootprint() const {
+        return {heapBytes(idIndex) + phoneIndex.memoryBytes() + nameIndex.memoryBytes() + scheduleIndex.memoryBytes()
+                    + heatmap.memoryBytes() + slotClaims.memoryBytes() + expiry.memoryBytes() + timers.memoryBytes(),
+                reservations.size()};
+    }
+
+    MemoryAccounting::Footprint internPoolFootprint() const {
+        return {nameIndex.internPoolBytes(), nameIndex.internedNames()};
+    }
+
+    vector<Reservation> findReservationsByPhone(const string& phoneNumber) const {
+        CapturedCall capture(TrafficCapture::FIND_BY_PHONE, venueId);
+        capture << phoneNumber;
+        vector<Reservation> matches;
+        const vector<string>* ids = phoneIndex.find(phoneNumber);
+        if (ids) {
+            for (const auto& id : *ids) {
+                matches.push_back(reservations[idIndex.at(id)]);
+            }
+        }
+        return matches;
+    }
+
+    // Short queries tolerate one typo, longer ones two.
+    vector<NameSearchIndex::Match> searchCustomersByName(const string& query, size_t limit = 10) const {
+        CapturedCall capture(TrafficCapture::SEARCH_BY_NAME, venueId);
+        capture << query << limit;
+        int maxDistance = query.size() <= 4 ? 1 : 2;
+        return nameIndex.search(query, maxDistance, limit);
+    }
+
+    vector<Reservation> getReservationsBetween(const string& fromDate, const string& toDate) const {
+        CapturedCall capture(TrafficCapture::BETWEEN, venueId);
+        capture << fromDate << toDate;
+        vector<Reservation> sheet;
+        for (const auto& id : scheduleIndex.idsBetween(fromDate, toDate)) {
+            sheet.push_back(reservations[idIndex.at(id)]);
+        }
+        return sheet;
+    }
+
+    vector<Reservation> getDaySheet(const string& date) const {
+        CapturedCall capture(TrafficCapture::DAY_SHEET, venueId);
+        capture << date;
+        return getReservationsBetween(date, date);
+    }
+
+    const Reservation& getReservation(const string& id) const {
+        CapturedCall capture(TrafficCapture::GET, venueId);
+        capture << id;
+        auto it = idIndex.find(toUpperCase(id));
+        if (it == idIndex.end()) {
+            throw ReservationException("Reservation ID not found.");
+        }
+        return reservations[it->second];
+    }
+
+    // Call without holding the shard. The compare-and-swap claim on slotClaims alone
+    // decides whether the booking goes ahead, so desks racing for one table never wait on
+    // the shard lock to find out; only the bookkeeping after a won claim takes it.
+    // Returns the table booked; the new reservation is also copied to *booked if given.
+    int reserveTable(const string& customerName, const string& phoneNumber,
+                    int partySize, const string& date, const string& time, int tableNumber,
+                    Reservation* booked = nullptr) {
+        USDT_SCOPE(reserve_table, partySize, tableNumber);
+        TraceRequest trace("reserveTable");
+        CapturedCall capture(TrafficCapture::RESERVE, venueId);
+        capture << customerName << phoneNumber << partySize << date << time << tableNumber;
+        requireWritable();
+        TraceSpan validation("validate");
+        if (!validatePhoneNumber(phoneNumber)) {
+            throw ReservationException("Invalid phone number format. Use XXX-XXX-XXXX.");
+        }
+        if (!validatePartySize(partySize)) {
+            throw ReservationException("Party size must be at least 1.");
+        }
+        if (!validateDate(date)) {
+            throw ReservationException("Invalid date format (use YYYY-MM-DD) or date is in the past.");
+        }
+        if (!validateTime(time, date)) {
+            throw ReservationException("Invalid time format (use HH:MM) or time is in the past for today.");
+        }
+        if (tableNumber < 0 || tableNumber >= tables.size()) {
+            throw ReservationException("Invalid table number. Must be between 1 and 10.");
+        }
+        validation.end();
+        TraceSpan claim("claim");
+        if (!slotClaims.claim(date, time, tableNumber)) {
+            throw TableUnavailableException(slotClaims.suggestAlternative(date, time));
+        }
+        claim.end();
+
+        auto shard = access();
+        string reservationId;
+        try {
+            requireWritable();
+            runDueTimers();
+            TraceSpan idLoop("id retry loop");
+            reservationId = "ID " + to_string(nextReservationId) + "A";
+            while (reservationIdExists(reservationId)) {
+                nextReservationId++;
+                reservationId = "ID " + to_string(nextReservationId) + "A";
+            }
+            nextReservationId++;
+            idLoop.end();
+            reservations.emplace_back(reservationId, customerName, phoneNumber, partySize, date, time, tableNumber);
+        } catch (...) {
+            slotClaims.release(date, time, tableNumber);
+            throw;
+        }
+
+        TraceSpan mutation("mutate");
+        indexReservation(reservations.size() - 1, true);
+        mutation.end();
+        saveReservations();
+        TraceSpan publish("publish");
+        publishMutation(MutationRecord::RESERVE, "", reservations.back());
+        noteMutation();
+        publish.end();
+        logReservationAction("Customer", customerName, "Reserved table",
+                            "#" + to_string(tableNumber + 1) + " for " + to_string(partySize) + " on " + date + " at " + time,
+                            reservationId, customerName, phoneNumber, partySize, date, time, tableNumber);
+        if (booked) {
+            *booked = reservations[idIndex.at(reservationId)];
+        }
+        return tableNumber;
+    }
+
+    void cancelReservation(const string& reservationId, const string& customerName) {
+        USDT_SCOPE(cancel_reservation, reservationId.c_str());
+        TraceRequest trace("cancelReservation");
+        CapturedCall capture(TrafficCapture::CANCEL, venueId);
+        capture << reservationId << customerName;
+        requireWritable();
+        TraceSpan validation("validate");
+        string upperId = toUpperCase(reservationId);
+        if (!validateReservationId(upperId)) {
+            throw ReservationException("Invalid reservation ID format. Use 'ID <number>A', e.g., ID 1A.");
+        }
+        bool hasReservation = false;
+        int tableIndex = -1;
+        string phoneNumber, date, time;
+        int partySize;
+        for (const auto& res : reservations) {
+            if (res.id == upperId) {
+                hasReservation = true;
+                tableIndex = res.tableNumber;
+                phoneNumber = res.phoneNumber;
+                partySize = res.partySize;
+                date = res.date;
+                time = res.time;
+                break;
+            }
+        }
+        if (!hasReservation) {
+            throw ReservationException("No reservation to cancel.");
+        }
+        validation.end();
+        TraceSpan mutation("mutate");
+        slotClaims.release(date, time, tableIndex);
+        size_t pos = idIndex.at(upperId);
+        Reservation cancelled = reservations[pos];
+        unindexReservation(reservations[pos]);
+        dropTimers(upperId);
+        reservations.erase(reservations.begin() + pos);
+        reindexPositionsFrom(pos);
+        mutation.end();
+        saveReservations();
+        TraceSpan publish("publish");
+        publishMutation(MutationRecord::CANCEL, upperId, cancelled);
+        noteMutation();
+        publish.end();
+        logReservationAction("Customer", customerName, "Cancelled reservation", "ID " + upperId,
+                            upperId, customerName, phoneNumber, partySize, date, time, tableIndex);
+    }
+
+    void viewCustomerReservations(ostream& out, const string& customerName) const {
+        CapturedCall capture(TrafficCapture::CUSTOMER_RESERVATIONS, venueId);
+        capture << customerName;
+        out << "\n--- Your Reservations ---\n";
+        bool hasReservations = false;
+        for (const auto& res : reservations) {
+            if (res.customerName == customerName) {
+                out << "ID: " << res.id << ", Name: " << res.customerName
+                    << ", Contact: " << res.phoneNumber << ", Party Size: " << res.partySize
+                    << ", Date: " << res.date << ", Time: " << res.time
+                    << ", Table: " << res.tableNumber + 1 << "\n";
+                hasReservations = true;
+            }
+        }
+        if (!hasReservations) {
+            out << "No reservation to view.\n";
+        }
+    }
+
+    void updateReservation(const string& reservationId, const string& customerName,
+                           const string& newId, const string& newName, const string& newPhone, int newPartySize,
+                           const string& newDate, const string& newTime, int newTableIndex) {
+        USDT_SCOPE(update_reservation, reservationId.c_str());
+        TraceRequest trace("updateReservation");
+        CapturedCall capture(TrafficCapture::UPDATE, venueId);
+        capture << reservationId << customerName << newId << newName << newPhone << newPartySize << newDate << newTime
+                << newTableIndex;
+        requireWritable();
+        TraceSpan validation("validate");
+        string upperId = toUpperCase(reservationId);
+        string upperNewId = newId == "0" ? "0" : toUpperCase(newId);
+        if (!validateReservationId(upperId)) {
+            throw ReservationException("Invalid reservation ID format. Use 'ID <number>A', e.g., ID 1A.");
+        }
+        bool hasReservation = false;
+        for (const auto& res : reservations) {
+            if (res.id == upperId) {
+                hasReservation = true;
+                break;
+            }
+        }
+        if (!hasReservation) {
+            throw ReservationException("No reservation to update.");
+        }
+
+        if (upperNewId != "0") {
+            if (!validateReservationId(upperNewId)) {
+                throw ReservationException("Invalid new reservation ID format. Use 'ID <number>A', e.g., ID 1A.");
+            }
+            if (reservationIdExists(upperNewId, upperId)) {
+                throw ReservationException("New reservation ID already exists. Choose a different ID.");
+            }
+        }
+        if (newPhone != "0" && !validatePhoneNumber(newPhone)) {
+            throw ReservationException("Invalid phone number format. Use XXX-XXX-XXXX.");
+        }
+        if (newPartySize != 0 && !validatePartySize(newPartySize)) {
+            throw ReservationException("Party size must be at least 1.");
+        }
+        if (newDate != "0" && !validateDate(newDate)) {
+            throw ReservationException("Invalid date format (use YYYY-MM-DD) or date is in the past.");
+        }
+        if (newTime != "0" && !validateTime(newTime, newDate != "0" ? newDate : Clock::read().date)) {
+            throw ReservationException("Invalid time format (use HH:MM) or time is in the past for today.");
+        }
+        validation.end();
+        runDueTimers();
+        if (!idIndex.count(upperId)) {
+            throw ReservationException("Reservation was already released as a no-show.");
+        }
+
+        TraceSpan mutation("mutate");
+        int oldTableIndex = -1;
+        for (auto& res : reservations) {
+            if (res.id == upperId) {
+                oldTableIndex = res.tableNumber;
+                break;
+            }
+        }
+        if (newTableIndex != -1) {
+            if (newTableIndex < 0 || newTableIndex >= tables.size()) {
+                throw ReservationException("Invalid new table index.");
+            }
+        } else {
+            newTableIndex = oldTableIndex;
+        }
+
+        const Reservation& current = reservations[idIndex.at(upperId)];
+        string claimDate = newDate != "0" ? newDate : current.date;
+        string claimTime = newTime != "0" ? newTime : current.time;
+        if (!slotClaims.move(current.date, current.time, oldTableIndex, claimDate, claimTime, newTableIndex)) {
+            throw TableUnavailableException(slotClaims.suggestAlternative(claimDate, claimTime));
+        }
+
+        string finalId = upperId;
+        string finalName = customerName;
+        string finalPhone = "";
+        int finalPartySize = 0;
+        string finalDate = "";
+        string finalTime = "";
+        for (auto& res : reservations) {
+            if (res.id == upperId) {
+                unindexReservation(res);
+                if (upperNewId != "0" && upperNewId != upperId) {
+                    bool carryCheckIn = timers.isCheckedIn(upperId);
+                    dropTimers(upperId);
+                    if (carryCheckIn) {
+                        timers.checkIn(upperNewId);
+                        saveCheckIns();
+                    }
+                }
+                bool moved = (newDate != "0" && newDate != res.date) || (newTime != "0" && newTime != res.time);
+                finalPhone = res.phoneNumber;
+                finalPartySize = res.partySize;
+                finalDate = res.date;
+                finalTime = res.time;
+                if (upperNewId != "0") {
+                    res.id = upperNewId;
+                    finalId = upperNewId;
+                }
+                if (newName != "0") {
+                    res.customerName = newName;
+                    finalName = newName;
+                }
+                if (newPhone != "0") {
+                    res.phoneNumber = newPhone;
+                    finalPhone = newPhone;
+                }
+                if (newPartySize != 0) {
+                    res.partySize = newPartySize;
+                    finalPartySize = newPartySize;
+                }
+                if (newDate != "0") {
+                    res.date = newDate;
+                    finalDate = newDate;
+                }
+                if (newTime != "0") {
+                    res.time = newTime;
+                    finalTime = newTime;
+                }
+                res.tableNumber = newTableIndex;
+                indexReservation(&res - &reservations[0], moved);
+                break;
+            }
+        }
+        mutation.end();
+        saveReservations();
+        TraceSpan publish("publish");
+        publishMutation(MutationRecord::UPDATE, upperId, reservations[idIndex.at(finalId)]);
+        noteMutation();
+        publish.end();
+        logReservationAction("Customer", customerName, "Updated reservation", "ID " + upperId,
+                            finalId, finalName, finalPhone, finalPartySize, finalDate, finalTime, newTableIndex);
+    }
+
+    // Snapshot and daily report work on a copy taken here, so they never touch the live
+    // book from the worker threads; the scrub checks reservations.txt against the last
+    // write. Overlapping runs are serialised through MaintenanceState.
+    void scheduleMaintenance() {
+        mutationsSinceMaintenance = 0;
+        auto copy = make_shared<const vector<Reservation>>(reservations);
+        string dir = storageDir;
+        shared_ptr<MaintenanceState> state = maintenance;
+        uint64_t run = ++maintenanceRuns;
+
+        scheduler.submit(TaskPriority::MAINTENANCE, [copy, dir, state, run] {
+            lock_guard<mutex> lock(state->runMutex);
+            if (run < state->snapshotRun) {
+                return; // a later run already wrote a newer snapshot
+            }
+            ofstream snapshotFile(dir + "reservations.snapshot");
+            if (!snapshotFile.is_open()) {
+                throw ReservationException("Unable to open reservations snapshot for writing.");
+            }
+            snapshotFile << serializeReservations(*copy);
+            state->snapshotRun = run;
+        });
+
+        scheduler.submit(TaskPriority::MAINTENANCE, [dir, state] {
+            lock_guard<mutex> lock(state->fileMutex);
+            if (!state->written) {
+                return; // nothing read or written yet to check against
+            }
+            ifstream resFile(dir + "reservations.txt");
+            stringstream onDisk;
+            onDisk << resFile.rdbuf();
+            string data = onDisk.str();
+            bool intact = checksum(data) == state->writtenChecksum;
+            ofstream scrubFile(dir + "scrub.txt", ios::app);
+            scrubFile << "reservations.txt " << (intact ? "OK" : "MISMATCH") << " ("
+                      << count(data.begin(), data.end(), '\n') << " reservations)\n";
+        });
+
+        scheduler.submit(TaskPriority::MAINTENANCE, [copy, dir, state, run] {
+            map<string, pair<int, int>> perDate; // date -> (reservations, guests)
+            for (const auto& res : *copy) {
+                perDate[res.date].first++;
+                perDate[res.date].second += res.partySize;
+            }
+            lock_guard<mutex> lock(state->runMutex);
+            if (run < state->reportRun) {
+                return;
+            }
+            ofstream reportFile(dir + "report.txt");
+            reportFile << "Date\t\tReservations\tGuests\n";
+            for (const auto& day : perDate) {
+                reportFile << day.first << "\t" << day.second.first << "\t\t" << day.second.second << "\n";
+            }
+            state->reportRun = run;
+        });
+    }
+
+    void viewLogs(ostream& out) {
+        CapturedCall capture(TrafficCapture::VIEW_LOGS, venueId);
+        out << "--- System Logs ---\n\n";
+        ifstream logFile(path("logs.txt"));
+        if (logFile.is_open()) {
+            string line;
+            while (getline(logFile, line)) {
+                out << line << "\n";
+            }
+            logFile.close();
+        } else {
+            out << "Unable to open log file.\n";
+        }
+    }
+};
+
+// -------- Venue Shards --------
+// One process serves every venue listed in venues.txt (one id per line); without that
+// file there is just the default venue. Each venue is its own ReservationManager shard,
+// so venues never share a store, an index or a log. Maintenance for all of them runs on
+// one shared scheduler.
+class VenueRegistry {
+private:
+    static unique_ptr<VenueRegistry> instance;
+    unique_ptr<WorkStealingPool> scheduler;
+    map<string, unique_ptr<ReservationManager>> shards;
+    vector<string> ids; // in venues.txt order
+    vector<function<void(const MutationRecord&)>> mutationListeners;
+    static bool standbyMode;
+    thread timerThread;
+    mutex timerMutex;
+    condition_variable timerWake;
+    bool stopTimers = false;
+
+    static bool isValidVenueId(const string& id) {
+        return !id.empty() && all_of(id.begin(), id.end(), [](char c) {
+            return isalnum(c) || c == '-' || c == '_';
+        });
+    }
+
+    VenueRegistry() {
+        scheduler.reset(new WorkStealingPool(max(2u, min(4u, thread::hardware_concurrency()))));
+        Instrumentation::registerSection("scheduler", [this](ostream& out) { scheduler->writeMetrics(out); });
+        Instrumentation::registerSection("venues", [this](ostream& out) {
+            for (const auto& id : ids) {
+                out << "venue " << id << ": " << shards.at(id)->access()->reservationCount() << " reservations\n";
+            }
+        });
+        Instrumentation::registerSection("timers", [this](ostream& out) {
+            for (const auto& id : ids) {
+                shards.at(id)->access()->writeTimerMetrics(out);
+            }
+        });
+        auto sumShards = [this](MemoryAccounting::Footprint (ReservationManager::*footprint)() const) {
+            return [this, footprint] {
+                MemoryAccounting::Footprint total;
+                for (const auto& shard : shards) {
+                    MemoryAccounting::Footprint part = ((*shard.second->access()).*footprint)();
+                    total.bytes += part.bytes;
+                    total.items += part.items;
+                }
+                return total;
+            };
+        };
+        MemoryAccounting::registerSource("store", "reservations", sumShards(&ReservationManager::storeFootprint));
+        MemoryAccounting::registerSource("indexes", "reservation_indexes", sumShards(&ReservationManager::indexFootprint));
+        MemoryAccounting::registerSource("intern_pool", "customer_names", sumShards(&ReservationManager::internPoolFootprint));
+
+        if (standbyMode) {
+            return; // venues arrive with the primary's snapshot
+        }
+        ifstream venuesFile("venues.txt");
+        string line;
+        while (getline(venuesFile, line)) {
+            if (isValidVenueId(line) && find(ids.begin(), ids.end(), line) == ids.end()) {
+                ids.push_back(line);
+            } else if (!line.empty()) {
+                cerr << "Warning: Ignoring invalid venue id \"" << line << "\" in venues.txt.\n";
+            }
+        }
+        if (ids.empty()) {
+            ids.push_back(DEFAULT_VENUE);
+        }
+        for (const auto& id : ids) {
+            shards[id].reset(new ReservationManager(id, id == ids.front(), *scheduler));
+        }
+    }
+
+public:
+    static const string DEFAULT_VENUE;
+
+    ~VenueRegistry() {
+        if (timerThread.joinable()) {
+            {
+                lock_guard<mutex> lock(timerMutex);
+                stopTimers = true;
+            }
+            timerWake.notify_all();
+            timerThread.join();
+        }
+        Instrumentation::unregisterSection("timers");
+        MemoryAccounting::unregisterSource("intern_pool", "customer_names");
+        MemoryAccounting::unregisterSource("indexes", "reservation_indexes");
+        MemoryAccounting::unregisterSource("store", "reservations");
+        Instrumentation::unregisterSection("venues");
+        Instrumentation::unregisterSection("scheduler");
+    }
+
+    // Lets snapshot, scrub and report tasks already queued finish writing.
+    void waitForMaintenance() {
+        scheduler->waitIdle();
+    }
+
+    static VenueRegistry& getInstance() {
+        if (!instance)
+            instance.reset(new VenueRegistry());
+        return *instance;
+    }
+
+    // Must be called before the first getInstance(): shards are then created empty and
+    // read-only, and only change through applyMutation().
+    static void startAsStandby() {
+        standbyMode = true;
+    }
+
+    bool isStandby() const {
+        return standbyMode;
+    }
+
+    // Listeners see every record committed on any venue, in commit order.
+    void addMutationListener(function<void(const MutationRecord&)> listener) {
+        mutationListeners.push_back(std::move(listener));
+        for (auto& shard : shards) {
+            shard.second->setMutationListener([this](const MutationRecord& record) {
+                for (const auto& notify : mutationListeners) {
+                    notify(record);
+                }
+            });
+        }
+    }
+
+    // An empty, read-only, in-memory shard, for copies kept outside the registry.
+    unique_ptr<ReservationManager> makeReplicaShard(const string& id, int nextReservationId = 1) const {
+        unique_ptr<ReservationManager> shard(new ReservationManager(id, id == ids.front(), *scheduler, true));
+        shard->restoreNextReservationId(nextReservationId);
+        return shard;
+    }
+
+    // Fires due timers on every venue twice a minute, so reminders and no-show releases
+    // happen on time even when nobody is booking. Not for standbys, whose venues are
+    // replaced under the follower.
+    void startTimers() {
+        if (standbyMode || timerThread.joinable()) {
+            return;
+        }
+        timerThread = thread([this] {
+            unique_lock<mutex> lock(timerMutex);
+            while (!timerWake.wait_for(lock, chrono::seconds(30), [this] { return stopTimers; })) {
+                for (const auto& id : ids) {
+                    try {
+                        shards.at(id)->access()->runDueTimers();
+                    } catch (const ReservationException& ex) {
+                        cerr << "Warning: Timers on venue " << id << ": " << ex.what() << "\n";
+                    }
+                }
+            }
+        });
+    }
+
+    // Standby only: drops whatever the venue held, ahead of a fresh snapshot.
+    void resetVenue(const string& id, int nextReservationId = 1) {
+        if (find(ids.begin(), ids.end(), id) == ids.end()) {
+            ids.push_back(id);
+        }
+        shards[id] = makeReplicaShard(id, nextReservationId);
+    }
+
+    void applyMutation(const MutationRecord& record) {
+        if (!shards.count(record.venue)) {
+            resetVenue(record.venue);
+        }
+        shards.at(record.venue)->access()->applyMutation(record);
+    }
+
+    void promote() {
+        for (auto& shard : shards) {
+            shard.second->access()->promote();
+        }
+        standbyMode = false;
+        startTimers(); // a standby never ran them
+    }
+
+    // The whole book as journal lines: "B|<venue>|<next-id>" resets a venue and the seq-0
+    // records after it rebuild it.
+    vector<string> snapshotLines() const {
+        vector<string> lines;
+        for (const auto& id : ids) {
+            auto shard = shards.at(id)->access();
+            lines.push_back("B|" + id + "|" + to_string(shard->getNextReservationId()));
+            for (const auto& res : shard->getAllReservations()) {
+                MutationRecord record;
+                record.venue = id;
+                record.nextReservationId = shard->getNextReservationId();
+                record.reservation = res;
+                lines.push_back(record.serialize());
+            }
+        }
+        return lines;
+    }
+
+    // The first venue listed owns the original files in the working directory.
+    const string& defaultVenue() const {
+        return ids.front();
+    }
+
+    const vector<string>& venueIds() const {
+        return ids;
+    }
+
+    ReservationManager& venue(const string& id) {
+        auto it = shards.find(id);
+        if (it == shards.end()) {
+            throw ReservationException("Unknown venue: " + id);
+        }
+        return *it->second;
+    }
+
+    // Runs a read-only query against every venue at once, as foreground tasks that the
+    // scheduler's workers take ahead of any queued maintenance, and returns the results in
+    // venue order. Not for use from a worker.
+    template <class Result>
+    vector<pair<string, Result>> queryAllVenues(const function<Result(const ReservationManager&)>& query) const {
+        vector<future<Result>> pending;
+        for (const auto& id : ids) {
+            const ReservationManager& shard = *shards.at(id);
+            auto answer = make_shared<promise<Result>>();
+            pending.push_back(answer->get_future());
+            scheduler->submit(TaskPriority::FOREGROUND, [&query, &shard, answer] {
+                try {
+                    answer->set_value(query(*shard.access()));
+                } catch (...) {
+                    answer->set_exception(current_exception());
+                }
+            });
+        }
+        vector<pair<string, Result>> results;
+        for (size_t i = 0; i < ids.size(); ++i) {
+            results.emplace_back(ids[i], pending[i].get());
+        }
+        return results;
+    }
+};
+
+unique_ptr<VenueRegistry> VenueRegistry::instance = nullptr;
+const string VenueRegistry::DEFAULT_VENUE = "main";
+bool VenueRegistry::standbyMode = false;
+
+// -------- Replication --------
+// The primary keeps every journal record since its last snapshot and streams them over a
+// Unix socket to its standbys. A standby opens with "HELLO|<epoch>|<seq>" (what it has
+// already applied). It gets "P|<epoch>", the snapshot if it has never seen this primary
+// or fell behind the last compaction, the records it is missing, "E|<seq>" once caught
+// up, and then live records. It acknowledges with "A|<seq>"; heartbeats "H|<seq>|<us>"
+// keep its view of the primary current while nothing is being booked.
+class ReplicationPublisher {
+private:
+    struct Standby {
+        int fd;
+        string inbound;
+        string outbound;
+        bool helloReceived = false;
+        bool caughtUp = false;
+        uint64_t nextSeq = 0;
+        uint64_t ackedSeq = 0;
+
+        explicit Standby(int fd) : fd(fd) {}
+    };
+
+    static const size_t COMPACT_AFTER = 100000;  // journal records kept before re-snapshotting
+    static const size_t MAX_OUTBOUND = 1 << 20;  // stop queueing for a standby that is not reading
+
+    string socketPath;
+    uint64_t epoch;
+    int listenFd = -1;
+    int wakeFds[2] = {-1, -1};
+
+    ProfiledMutex<mutex> journalMutex{"replication journal"};
+    uint64_t headSeq = 0;
+    uint64_t snapshotSeq = 0;
+    vector<string> snapshot;
+    deque<string> journal; // records snapshotSeq + 1 .. headSeq
+
+    vector<Standby> standbys; // sender thread only
+    atomic<int> connectedStandbys{0};
+    atomic<uint64_t> slowestAckedSeq{0};
+    atomic<uint64_t> recordsSent{0};
+    atomic<bool> stopping{false};
+    thread sender;
+
+    static void setNonBlocking(int fd) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    }
+
+    void handleLine(Standby& standby, const string& line) {
+        vector<string> fields;
+        stringstream ss(line);
+        string field;
+        while (getline(ss, field, '|')) {
+            fields.push_back(field);
+        }
+        try {
+            if (fields.size() == 3 && fields[0] == "HELLO") {
+                standby.helloReceived = true;
+                uint64_t appliedSeq = stoull(fields[2]);
+                standby.nextSeq = stoull(fields[1]) == epoch ? appliedSeq + 1 : 0;
+                standby.outbound += "P|" + to_string(epoch) + "\n";
+            } else if (fields.size() == 2 && fields[0] == "A") {
+                standby.ackedSeq = max(standby.ackedSeq, static_cast<uint64_t>(stoull(fields[1])));
+            }
+        } catch (...) {
+            // ignore malformed control lines
+        }
+    }
+
+    // Replays the journal onto the snapshot lines themselves, so compaction never has to
+    // lock a live shard. Caller holds journalMutex.
+    void foldJournal() {
+        struct VenueBook {
+            int nextReservationId = 1;
+            vector<Reservation> rows;
+            vector<bool> removed;
+            unordered_map<string, size_t> positions;
+        };
+        vector<string> order;
+        map<string, VenueBook> books;
+        auto bookFor = [&](const string& venue) -> VenueBook& {
+            if (!books.count(venue)) {
+                order.push_back(venue);
+            }
+            return books[venue];
+        };
+
+        MutationRecord record;
+        for (const auto& line : snapshot) {
+            if (line.compare(0, 2, "B|") == 0) {
+                size_t bar = line.find('|', 2);
+                bookFor(line.substr(2, bar - 2)).nextReservationId = stoi(line.substr(bar + 1));
+            } else if (MutationRecord::parse(line, record)) {
+                VenueBook& book = bookFor(record.venue);
+                book.positions[record.reservation.id] = book.rows.size();
+                book.rows.push_back(record.reservation);
+                book.removed.push_back(false);
+            }
+        }
+        for (const auto& line : journal) {
+            if (!MutationRecord::parse(line, record)) {
+                continue;
+            }
+            VenueBook& book = bookFor(record.venue);
+            book.nextReservationId = max(book.nextReservationId, record.nextReservationId);
+            auto it = book.positions.find(record.oldId);
+            if (record.op != MutationRecord::RESERVE && it != book.positions.end()) {
+                size_t pos = it->second;
+                book.positions.erase(it);
+                if (record.op == MutationRecord::UPDATE) {
+                    book.rows[pos] = record.reservation;
+                    book.positions[record.reservation.id] = pos;
+                } else {
+                    book.removed[pos] = true;
+                }
+            } else if (record.op != MutationRecord::CANCEL) {
+                book.positions[record.reservation.id] = book.rows.size();
+                book.rows.push_back(record.reservation);
+                book.removed.push_back(false);
+            }
+        }
+
+        snapshot.clear();
+        for (const auto& venue : order) {
+            const VenueBook& book = books[venue];
+            snapshot.push_back("B|" + venue + "|" + to_string(book.nextReservationId));
+            for (size_t i = 0; i < book.rows.size(); ++i) {
+                if (!book.removed[i]) {
+                    MutationRecord row;
+                    row.venue = venue;
+                    row.nextReservationId = book.nextReservationId;
+                    row.reservation = book.rows[i];
+                    snapshot.push_back(row.serialize());
+                }
+            }
+        }
+        snapshotSeq = headSeq;
+        journal.clear();
+    }
+
+    // Queues whatever the standby has not been sent yet.
+    void fill(Standby& standby) {
+        ProfiledLock<mutex> lock(journalMutex);
+        if (standby.nextSeq <= snapshotSeq) {
+            for (const auto& line : snapshot) {
+                standby.outbound += line + "\n";
+            }
+            standby.nextSeq = snapshotSeq + 1;
+        }
+        while (standby.nextSeq <= headSeq && standby.outbound.size() < MAX_OUTBOUND) {
+            standby.outbound += journal[standby.nextSeq - snapshotSeq - 1] + "\n";
+            standby.nextSeq++;
+            recordsSent++;
+        }
+        if (!standby.caughtUp && standby.nextSeq > headSeq) {
+            standby.outbound += "E|" + to_string(headSeq) + "\n";
+            standby.caughtUp = true;
+        }
+    }
+
+    // Returns false when the standby has gone away.
+    bool flush(Standby& standby) {
+        while (!standby.outbound.empty()) {
+            ssize_t written = send(standby.fd, standby.outbound.data(), standby.outbound.size(), MSG_NOSIGNAL);
+            if (written < 0) {
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+            standby.outbound.erase(0, written);
+        }
+        return true;
+    }
+
+    bool read(Standby& standby) {
+        char buffer[4096];
+        while (true) {
+            ssize_t received = recv(standby.fd, buffer, sizeof(buffer), 0);
+            if (received == 0) {
+                return false;
+            }
+            if (received < 0) {
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+            standby.inbound.append(buffer, received);
+            size_t newline;
+            while ((newline = standby.inbound.find('\n')) != string::npos) {
+                string line = standby.inbound.substr(0, newline);
+                standby.inbound.erase(0, newline + 1);
+                handleLine(standby, line);
+            }
+        }
+    }
+
+    void run() {
+        auto lastHeartbeat = chrono::steady_clock::now();
+        while (!stopping) {
+            vector<pollfd> fds = {{listenFd, POLLIN, 0}, {wakeFds[0], POLLIN, 0}};
+            for (const auto& standby : standbys) {
+                fds.push_back({standby.fd, static_cast<short>(POLLIN | (standby.outbound.empty() ? 0 : POLLOUT)), 0});
+            }
+            poll(fds.data(), fds.size(), 1000);
+
+            if (fds[1].revents & POLLIN) {
+                char drain[256];
+                while (::read(wakeFds[0], drain, sizeof(drain)) > 0) {
+                }
+            }
+            vector<bool> alive(standbys.size(), true);
+            for (size_t i = 0; i < standbys.size(); ++i) {
+                if (fds[i + 2].revents & (POLLIN | POLLHUP | POLLERR)) {
+                    alive[i] = read(standbys[i]);
+                }
+            }
+            if (fds[0].revents & POLLIN) {
+                int fd;
+                while ((fd = accept(listenFd, nullptr, nullptr)) >= 0) {
+                    setNonBlocking(fd);
+                    standbys.emplace_back(fd);
+                    alive.push_back(true);
+                }
+            }
+
+            bool heartbeat = chrono::steady_clock::now() - lastHeartbeat >= chrono::seconds(1);
+            if (heartbeat) {
+                lastHeartbeat = chrono::steady_clock::now();
+            }
+            uint64_t slowest = UINT64_MAX;
+            for (size_t i = 0; i < standbys.size(); ++i) {
+                Standby& standby = standbys[i];
+                if (alive[i] && standby.helloReceived) {
+                    fill(standby);
+                    if (heartbeat) {
+                        ProfiledLock<mutex> lock(journalMutex);
+                        standby.outbound += "H|" + to_string(headSeq) + "|" + to_string(MutationRecord::nowMicros()) + "\n";
+                    }
+                }
+                if (alive[i]) {
+                    alive[i] = flush(standby);
+                }
+                if (alive[i]) {
+                    slowest = min(slowest, standby.ackedSeq);
+                }
+            }
+            for (size_t i = standbys.size(); i-- > 0;) {
+                if (!alive[i]) {
+                    close(standbys[i].fd);
+                    standbys.erase(standbys.begin() + i);
+                }
+            }
+            connectedStandbys = standbys.size();
+            slowestAckedSeq = standbys.empty() ? 0 : slowest;
+        }
+    }
+
+public:
+    explicit ReplicationPublisher(const string& path)
+        : socketPath(path), epoch(random_device()() | (static_cast<uint64_t>(random_device()()) << 32)) {}
+
+    ~ReplicationPublisher() {
+        MemoryAccounting::unregisterSource("log_buffers", "replication_journal");
+        Instrumentation::unregisterSection("replication");
+        stopping = true;
+        if (sender.joinable()) {
+            ::write(wakeFds[1], "x", 1);
+            sender.join();
+        }
+        for (const auto& standby : standbys) {
+            close(standby.fd);
+        }
+        for (int fd : {listenFd, wakeFds[0], wakeFds[1]}) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+        if (listenFd >= 0) {
+            unlink(socketPath.c_str());
+        }
+    }
+
+    // Starts with the book as it is now; records published later are streamed on top.
+    bool start(const vector<string>& initialSnapshot) {
+        snapshot = initialSnapshot;
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(address.sun_path)) {
+            cerr << "Error: Replication socket path is too long.\n";
+            return false;
+        }
+        strcpy(address.sun_path, socketPath.c_str());
+        unlink(socketPath.c_str());
+        listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+            || listen(listenFd, 8) < 0 || pipe(wakeFds) < 0) {
+            cerr << "Error: Unable to open replication socket " << socketPath << ".\n";
+            return false;
+        }
+        setNonBlocking(listenFd);
+        setNonBlocking(wakeFds[0]);
+        setNonBlocking(wakeFds[1]);
+        sender = thread([this] { run(); });
+
+        MemoryAccounting::registerSource("log_buffers", "replication_journal", [this] {
+            ProfiledLock<mutex> lock(journalMutex);
+            MemoryAccounting::Footprint footprint{heapBytes(snapshot), snapshot.size() + journal.size()};
+            for (const auto& record : journal) {
+                footprint.bytes += sizeof(string) + heapBytes(record);
+            }
+            return footprint;
+        });
+        Instrumentation::registerSection("replication", [this](ostream& out) {
+            ProfiledLock<mutex> lock(journalMutex);
+            uint64_t acked = slowestAckedSeq;
+            out << "role primary\n";
+            out << "epoch " << epoch << "\n";
+            out << "head_seq " << headSeq << "\n";
+            out << "snapshot_seq " << snapshotSeq << "\n";
+            out << "journal_records " << journal.size() << "\n";
+            out << "standbys " << connectedStandbys << "\n";
+            out << "slowest_acked_seq " << acked << "\n";
+            out << "lag_records " << (connectedStandbys ? headSeq - min(acked, headSeq) : 0) << "\n";
+            out << "records_sent " << recordsSent << "\n";
+        });
+        return true;
+    }
+
+    // Called on the mutation path: numbers and stores the record, then wakes the sender.
+    // Every COMPACT_AFTER records the journal is folded into a fresh snapshot.
+    void publish(MutationRecord record) {
+        {
+            ProfiledLock<mutex> lock(journalMutex);
+            record.seq = ++headSeq;
+            journal.push_back(record.serialize());
+            if (journal.size() >= COMPACT_AFTER) {
+                foldJournal();
+            }
+        }
+        ::write(wakeFds[1], "x", 1);
+    }
+};
+
+// Standby side of the stream. Its socket is polled by the session reactor, so replayed
+// records and read-only sessions never run at the same time.
+class ReplicationFollower {
+private:
+    int fd = -1;
+    string inbound;
+    uint64_t epoch = 0;
+    uint64_t appliedSeq = 0;
+    uint64_t primarySeq = 0;
+    bool caughtUp = false;
+    bool promoted = false;
+
+    uint64_t appliedRecords = 0;
+    int64_t applyBusyMicros = 0;
+    int64_t lastLagMicros = 0;
+    int64_t maxLagMicros = 0;
+    int64_t totalLagMicros = 0;
+    uint64_t liveRecords = 0;
+
+    void handleLine(const string& line) {
+        VenueRegistry& registry = VenueRegistry::getInstance();
+        try {
+            if (line.compare(0, 2, "M|") == 0) {
+                MutationRecord record;
+                if (!MutationRecord::parse(line, record) || (record.seq != 0 && record.seq <= appliedSeq)) {
+                    return;
+                }
+                auto start = chrono::steady_clock::now();
+                registry.applyMutation(record);
+                applyBusyMicros += chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+                appliedRecords++;
+                if (record.seq != 0) {
+                    appliedSeq = record.seq;
+                    primarySeq = max(primarySeq, record.seq);
+                    if (caughtUp) {
+                        lastLagMicros = max<int64_t>(0, MutationRecord::nowMicros() - record.commitMicros);
+                        maxLagMicros = max(maxLagMicros, lastLagMicros);
+                        totalLagMicros += lastLagMicros;
+                        liveRecords++;
+                    }
+                }
+                return;
+            }
+            vector<string> fields;
+            stringstream ss(line);
+            string field;
+            while (getline(ss, field, '|')) {
+                fields.push_back(field);
+            }
+            if (fields.size() == 2 && fields[0] == "P") {
+                epoch = stoull(fields[1]);
+            } else if (fields.size() == 3 && fields[0] == "B") {
+                registry.resetVenue(fields[1], stoi(fields[2]));
+            } else if (fields.size() == 2 && fields[0] == "E") {
+                primarySeq = max(primarySeq, static_cast<uint64_t>(stoull(fields[1])));
+                appliedSeq = max(appliedSeq, primarySeq);
+                caughtUp = true;
+            } else if (fields.size() == 3 && fields[0] == "H") {
+                primarySeq = max(primarySeq, static_cast<uint64_t>(stoull(fields[1])));
+            }
+        } catch (...) {
+            cerr << "Warning: Ignoring malformed replication line.\n";
+        }
+    }
+
+    void acknowledge() {
+        string ack = "A|" + to_string(appliedSeq) + "\n";
+        send(fd, ack.data(), ack.size(), MSG_NOSIGNAL);
+    }
+
+    enum class ReadResult { DATA, WOULD_BLOCK, CLOSED };
+
+    ReadResult receive(bool blocking) {
+        char buffer[65536];
+        ssize_t received = recv(fd, buffer, sizeof(buffer), blocking ? 0 : MSG_DONTWAIT);
+        if (received <= 0) {
+            bool wouldBlock = received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+            return wouldBlock ? ReadResult::WOULD_BLOCK : ReadResult::CLOSED;
+        }
+        inbound.append(buffer, received);
+        size_t start = 0, newline;
+        while ((newline = inbound.find('\n', start)) != string::npos) {
+            handleLine(inbound.substr(start, newline - start));
+            start = newline + 1;
+        }
+        inbound.erase(0, start);
+        return ReadResult::DATA;
+    }
+
+public:
+    ~ReplicationFollower() {
+        Instrumentation::unregisterSection("replication");
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    // Connects and replays everything the primary has, blocking until caught up.
+    bool connectAndCatchUp(const string& socketPath) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            cerr << "Error: Unable to reach the primary at " << socketPath << ".\n";
+            return false;
+        }
+        string hello = "HELLO|" + to_string(epoch) + "|" + to_string(appliedSeq) + "\n";
+        send(fd, hello.data(), hello.size(), MSG_NOSIGNAL);
+        while (!caughtUp) {
+            if (receive(true) == ReadResult::CLOSED) {
+                cerr << "Error: The primary closed the stream during catch-up.\n";
+                return false;
+            }
+        }
+        acknowledge();
+
+        Instrumentation::registerSection("replication", [this](ostream& out) {
+            out << "role " << (promoted ? "promoted" : "standby") << "\n";
+            out << "epoch " << epoch << "\n";
+            out << "applied_seq " << appliedSeq << "\n";
+            out << "primary_seq " << primarySeq << "\n";
+            out << "lag_records " << primarySeq - appliedSeq << "\n";
+            out << "last_lag_us " << lastLagMicros << "\n";
+            out << "avg_lag_us " << (liveRecords ? totalLagMicros / static_cast<int64_t>(liveRecords) : 0) << "\n";
+            out << "max_lag_us " << maxLagMicros << "\n";
+            out << "applied_records " << appliedRecords << "\n";
+            out << "apply_throughput_per_s "
+                << (applyBusyMicros ? static_cast<long>(appliedRecords * 1e6 / applyBusyMicros) : 0) << "\n";
+        });
+        return true;
+    }
+
+    int getFd() const {
+        return fd;
+    }
+
+    // Applies whatever has arrived. When the primary goes away the standby promotes
+    // itself: the book is already current, so this only writes it out.
+    bool readAvailable() {
+        ReadResult result;
+        while ((result = receive(false)) == ReadResult::DATA) {
+        }
+        if (result == ReadResult::WOULD_BLOCK) {
+            acknowledge();
+            return true;
+        }
+        VenueRegistry::getInstance().promote();
+        promoted = true;
+        cerr << "Primary disconnected at seq " << appliedSeq << "; this standby is now the primary.\n";
+        return false;
+    }
+};
+
+// -------- Read Replicas --------
+// Listing, search and report queries can be answered by replica workers instead of the
+// primary. Each worker owns a private in-memory copy of every venue, seeded from a
+// snapshot and kept current by the mutation journal. Records and queries share one FIFO
+// per worker, so a query always sees every change committed before it was submitted.
+class ReadReplicaPool {
+public:
+    using Query = function<void(const ReservationManager*)>; // null if the venue is unknown
+
+private:
+    struct Item {
+        shared_ptr<const MutationRecord> record; // set for journal records
+        string venue;                            // otherwise a query on this venue
+        Query query;
+    };
+
+    struct Worker {
+        mutex queueMutex;
+        condition_variable ready;
+        deque<Item> queue;
+        atomic<size_t> depth{0};
+        atomic<uint64_t> recordsApplied{0};
+        atomic<uint64_t> queriesServed{0};
+        atomic<uint64_t> queryMicros{0};
+        map<string, unique_ptr<ReservationManager>> book; // owned by the worker thread
+        thread runner;
+    };
+
+    vector<unique_ptr<Worker>> workers;
+    size_t nextWorker = 0; // ties go round-robin
+    atomic<bool> stopping{false};
+
+    void run(Worker& worker) {
+        while (true) {
+            Item item;
+            {
+                unique_lock<mutex> lock(worker.queueMutex);
+                worker.ready.wait(lock, [&] { return stopping || !worker.queue.empty(); });
+                if (worker.queue.empty()) {
+                    return;
+                }
+                item = std::move(worker.queue.front());
+                worker.queue.pop_front();
+            }
+            if (item.record) {
+                auto shard = worker.book.find(item.record->venue);
+                if (shard != worker.book.end()) {
+                    shard->second->applyMutation(*item.record);
+                }
+                worker.recordsApplied++;
+            } else {
+                auto start = chrono::steady_clock::now();
+                auto shard = worker.book.find(item.venue);
+                item.query(shard == worker.book.end() ? nullptr : shard->second.get());
+                worker.queryMicros +=
+                    chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+                worker.queriesServed++;
+            }
+            worker.depth--;
+        }
+    }
+
+    void push(Worker& worker, Item item) {
+        {
+            lock_guard<mutex> lock(worker.queueMutex);
+            worker.queue.push_back(std::move(item));
+        }
+        worker.depth++;
+        worker.ready.notify_one();
+    }
+
+public:
+    // Builds every replica from the registry's current book; call on the thread that
+    // owns the registry, then feed it with publish().
+    explicit ReadReplicaPool(int workerCount) {
+        VenueRegistry& registry = VenueRegistry::getInstance();
+        vector<string> snapshot = registry.snapshotLines();
+        for (int i = 0; i < workerCount; ++i) {
+            unique_ptr<Worker> worker(new Worker());
+            for (const auto& id : registry.venueIds()) {
+                worker->book[id] = registry.makeReplicaShard(id, registry.venue(id).access()->getNextReservationId());
+            }
+            MutationRecord record;
+            for (const auto& line : snapshot) {
+                if (MutationRecord::parse(line, record)) {
+                    worker->book.at(record.venue)->applyMutation(record);
+                }
+            }
+            workers.push_back(std::move(worker));
+        }
+        for (auto& worker : workers) {
+            Worker* target = worker.get();
+            worker->runner = thread([this, target] { run(*target); });
+        }
+        Instrumentation::registerSection("replicas", [this](ostream& out) {
+            out << "workers " << workers.size() << "\n";
+            for (size_t i = 0; i < workers.size(); ++i) {
+                const Worker& worker = *workers[i];
+                uint64_t served = worker.queriesServed;
+                out << "replica" << i << ".queue_depth " << worker.depth << "\n";
+                out << "replica" << i << ".records_applied " << worker.recordsApplied << "\n";
+                out << "replica" << i << ".queries_served " << served << "\n";
+                out << "replica" << i << ".avg_query_us " << (served ? worker.queryMicros / served : 0) << "\n";
+            }
+        });
+    }
+
+    ~ReadReplicaPool() {
+        Instrumentation::unregisterSection("replicas");
+        stopping = true;
+        for (auto& worker : workers) {
+            {
+                lock_guard<mutex> lock(worker->queueMutex);
+            }
+            worker->ready.notify_all();
+        }
+        for (auto& worker : workers) {
+            worker->runner.join();
+        }
+    }
+
+    void publish(const MutationRecord& record) {
+        auto shared = make_shared<const MutationRecord>(record);
+        for (auto& worker : workers) {
+            push(*worker, Item{shared, "", nullptr});
+        }
+    }
+
+    // Runs on the least busy replica; any replica has already applied every record
+    // published before this call.
+    void submit(const string& venue, Query query) {
+        nextWorker = (nextWorker + 1) % workers.size();
+        Worker* target = workers[nextWorker].get();
+        for (auto& worker : workers) {
+            if (worker->depth < target->depth) {
+                target = worker.get();
+            }
+        }
+        push(*target, Item{nullptr, venue, std::move(query)});
+    }
+};
+
+// -------- Session Coroutines --------
+// Menu flows are coroutines: every prompt suspends the flow until its session receives a
+// line, so one thread can interleave any number of sessions. A Task starts when first
+// awaited (or start()ed) and, when it finishes, resumes whoever was awaiting it. Requires
+// C++20 (-std=c++20); the scheduler and benchmarks also need -pthread.
+template <class T> class Task;
+
+struct TaskPromiseBase {
+    coroutine_handle<> continuation = noop_coroutine();
+    exception_ptr error;
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template <class Promise>
+        coroutine_handle<> await_suspend(coroutine_handle<Promise> finished) noexcept {
+            return finished.promise().continuation;
+        }
+        void await_resume() noexcept {}
+    };
+
+    suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() { error = current_exception(); }
+
+    // Suspended menu flows are most of what a session costs, so frames are counted.
+    static atomic<size_t> frameBytes;
+    static atomic<size_t> frames;
+
+    // Out of line so GCC pairs the frame's new and delete instead of seeing malloc/free.
+    __attribute__((noinline)) static void* operator new(size_t size) {
+        frameBytes += size;
+        frames++;
+        return ::operator new(size);
+    }
+
+    __attribute__((noinline)) static void operator delete(void* frame, size_t size) {
+        frameBytes -= size;
+        frames--;
+        ::operator delete(frame, size);
+    }
+};
+
+atomic<size_t> TaskPromiseBase::frameBytes{0};
+atomic<size_t> TaskPromiseBase::frames{0};
+
+template <class T>
+struct TaskPromise : TaskPromiseBase {
+    T value{};
+    Task<T> get_return_object();
+    void return_value(T result) { value = std::move(result); }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+    void return_void() {}
+};
+
+template <class T>
+class Task {
+public:
+    using promise_type = TaskPromise<T>;
+
+private:
+    coroutine_handle<promise_type> handle;
+
+public:
+    explicit Task(coroutine_handle<promise_type> h) : handle(h) {}
+    Task(Task&& other) noexcept : handle(exchange(other.handle, nullptr)) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    // Destroying a suspended task also destroys every task it is awaiting.
+    ~Task() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return handle.done(); }
+    coroutine_handle<> await_suspend(coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+    T await_resume() {
+        if (handle.promise().error) {
+            rethrow_exception(handle.promise().error);
+        }
+        if constexpr (!is_void_v<T>) {
+            return std::move(handle.promise().value);
+        }
+    }
+
+    void start() { handle.resume(); }
+    bool done() const { return handle.done(); }
+    exception_ptr error() const { return handle.promise().error; }
+};
+
+template <class T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// One interactive user. Output goes to the session's stream; input arrives through
+// deliverLine() (console) or feed() (socket), and co_await readLine() suspends the
+// flow until there is a line to hand it.
+class Session {
+private:
+    ostream& output;
+    deque<string> pendingLines;
+    string partialLine;
+    coroutine_handle<> waiting;
+    string* waitingLine = nullptr;
+
+    // Read routing. Without replicas, queries run inline on the primary; with them the
+    // flow suspends and `resumer` hands it back to the session's own thread. `alive`
+    // lets a late answer notice that the session has since been closed.
+    ReadReplicaPool* replicas = nullptr;
+    function<void(coroutine_handle<>, shared_ptr<bool>)> resumer;
+    shared_ptr<bool> alive = make_shared<bool>(true);
+
+public:
+    explicit Session(ostream& out) : output(out) {}
+
+    ~Session() {
+        *alive = false;
+    }
+
+    ostream& out() {
+        return output;
+    }
+
+    void routeReads(ReadReplicaPool* pool, function<void(coroutine_handle<>, shared_ptr<bool>)> resumeOnOwner) {
+        replicas = pool;
+        resumer = std::move(resumeOnOwner);
+    }
+
+    template <class Result>
+    struct ReadAwaiter {
+        struct Answer {
+            Result value{};
+            exception_ptr error;
+        };
+
+        Session& session;
+        string venue;
+        function<Result(const ReservationManager&)> query;
+        shared_ptr<Answer> answer = make_shared<Answer>();
+
+        bool await_ready() {
+            if (session.replicas) {
+                return false;
+            }
+            answer->value = query(*VenueRegistry::getInstance().venue(venue).access());
+            return true;
+        }
+        void await_suspend(coroutine_handle<> flow) {
+            auto resume = session.resumer;
+            auto alive = session.alive;
+            session.replicas->submit(venue, [answer = answer, query = query, venue = venue, resume, alive, flow](
+                                                const ReservationManager* shard) {
+                try {
+                    if (!shard) {
+                        throw ReservationException("Unknown venue: " + venue);
+                    }
+                    answer->value = query(*shard);
+                } catch (...) {
+                    answer->error = current_exception();
+                }
+                resume(flow, alive);
+            });
+        }
+        Result await_resume() {
+            if (answer->error) {
+                rethrow_exception(answer->error);
+            }
+            return std::move(answer->value);
+        }
+    };
+
+    // co_await session.read(venue, query): a read-only query on one venue's book. Pass a
+    // named lambda; GCC 12 destroys capturing lambda temporaries inside co_await twice.
+    template <class Query>
+    auto read(const string& venue, Query query) {
+        using Result = decltype(query(declval<const ReservationManager&>()));
+        return ReadAwaiter<Result>{*this, venue, std::move(query)};
+    }
+
+    struct LineAwaiter {
+        Session& session;
+        string& line;
+
+        bool await_ready() {
+            if (session.pendingLines.empty()) {
+                return false;
+            }
+            line = std::move(session.pendingLines.front());
+            session.pendingLines.pop_front();
+            return true;
+        }
+        void await_suspend(coroutine_handle<> flow) {
+            session.waiting = flow;
+            session.waitingLine = &line;
+        }
+        void await_resume() {}
+    };
+
+    LineAwaiter readLine(string& line) {
+        return {*this, line};
+    }
+
+    bool isWaitingForInput() const {
+        return static_cast<bool>(waiting);
+    }
+
+    void deliverLine(string line) {
+        if (!waiting) {
+            pendingLines.push_back(std::move(line));
+            return;
+        }
+        *waitingLine = std::move(line);
+        coroutine_handle<> flow = exchange(waiting, nullptr);
+        flow.resume();
+    }
+
+    // Raw bytes from a socket; complete lines are delivered, the rest is kept.
+    void feed(const char* data, size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            if (data[i] == '\n') {
+                if (!partialLine.empty() && partialLine.back() == '\r') {
+                    partialLine.pop_back();
+                }
+                deliverLine(exchange(partialLine, string()));
+            } else {
+                partialLine += data[i];
+            }
+        }
+    }
+};
+
+// -------- Abstraction + Polymorphism --------
+class User {
+protected:
+    string username;
+    string role;
+    string venueId;
+
+    // The venue shard this user signed in to, held for the rest of the statement.
+    ShardAccess<ReservationManager> venue(const source_location& site = source_location::current()) const {
+        return VenueRegistry::getInstance().venue(venueId).access(site);
+    }
+
+    // The shard without its lock, for calls such as reserveTable that lock it themselves.
+    ReservationManager& unlockedVenue() const {
+        return VenueRegistry::getInstance().venue(venueId);
+    }
+
+public:
+    User(const string& name, const string& r, const string& password, const string& venue)
+        : username(name), role(r), venueId(venue) {
+        this->venue()->logLogin(role, name, password);
+    }
+    virtual Task<bool> showMenu(Session& session) = 0;
+    virtual ~User() = default;
+};
+
+// Account database
+map<string, string> receptionistAccounts;
+map<string, string> customerAccounts;
+
+// -------- Helper Functions for Customer Accounts --------
+void saveCustomerAccounts(const map<string, string>& accounts) {
+    ofstream accountsFile("customer_accounts.txt");
+    if (!accountsFile.is_open()) {
+        cerr << "Error: Unable to open customer_accounts.txt for writing." << "\n";
+        return;
+    }
+    for (const auto& account : accounts) {
+        accountsFile << account.first << "|" << account.second << "\n";
+    }
+    accountsFile.close();
+}
+
+void loadCustomerAccounts(map<string, string>& accounts) {
+    ifstream accountsFile("customer_accounts.txt");
+    if (accountsFile.is_open()) {
+        string line;
+        while (getline(accountsFile, line)) {
+            stringstream ss(line);
+            string username, password;
+            getline(ss, username, '|');
+            getline(ss, password);
+            accounts[username] = password;
+        }
+        accountsFile.close();
+    }
+}
+
+// -------- Inheritance for Roles --------
+bool isValidCredential(const string& input) {
+    USDT_SCOPE(validate_credential);
+    if (input.empty()) {
+        return false;
+    }
+    return none_of(input.begin(), input.end(), ::isspace);
+}
+
+class Customer : public User {
+public:
+    Customer(const string& name, const string& password, const string& venue)
+        : User(name, "Customer", password, venue) {}
+
+    static Task<unique_ptr<User>> signIn(Session& session, bool isNewAccount, const string& venue) {
+        ostream& out = session.out();
+        string name, password;
+        if (isNewAccount) {
+            bool usernameValid = false;
+            while (!usernameValid) {
+                out << "Enter username (no spaces allowed): ";
+                co_await session.readLine(name);
+                if (!isValidCredential(name)) {
+                    out << "Error: Username cannot be empty or contain spaces.\n";
+                    continue;
+                }
+                if (customerAccounts.count(name)) {
+                    out << "Account already exists. Please choose a different username.\n";
+                    continue;
+                }
+                usernameValid = true;
+            }
+            bool passwordValid = false;
+            while (!passwordValid) {
+                out << "Enter password (no spaces allowed): ";
+                co_await session.readLine(password);
+                if (!isValidCredential(password)) {
+                    out << "Error: Password cannot be empty or contain spaces.\n";
+                    continue;
+                }
+                passwordValid = true;
+            }
+            customerAccounts[name] = password;
+            saveCustomerAccounts(customerAccounts);
+            out << "Customer account created.\n";
+        } else {
+            bool credentialsValid = false;
+            while (!credentialsValid) {
+                out << "Enter username: ";
+                co_await session.readLine(name);
+                out << "Enter password: ";
+                co_await session.readLine(password);
+                if (customerAccounts.count(name) && customerAccounts[name] == password) {
+                    credentialsValid = true;
+                } else {
+                    out << "Invalid credentials. Please try again.\n";
+                }
+            }
+        }
+        co_return unique_ptr<User>(new Customer(name, password, venue));
+    }
+
+    Task<bool> showMenu(Session& session) override {
+        ostream& out = session.out();
+        bool isRunning = true;
+        while (isRunning) {
+            string input;
+            int choice;
+            out << "\n[Customer Menu - " << username << "]\n";
+            out << "1. View My Reservations\n";
+            out << "2. View Availability\n";
+            out << "3. Reserve Table\n";
+            out << "4. Update Reservation\n";
+            out << "5. Cancel Reservation\n";
+            out << "7. View Availability by Time\n";
+            out << "6. Exit\nChoice: ";
+            co_await session.readLine(input);
+
+            if (!validateNumericInput(input, choice, 1, 7)) {
+                out << "Invalid choice. Please enter a single number between 1 and 7.\n";
+                continue;
+            }
+
+            switch (choice) {
+                case 1: {
+                    auto myReservations = [name = username](const ReservationManager& shard) {
+                        ostringstream text;
+                        shard.viewCustomerReservations(text, name);
+                        return text.str();
+                    };
+                    out << co_await session.read(venueId, myReservations);
+                    break;
+                }
+                case 2:
+                    venue()->viewTableAvailability(out);
+                    break;
+                case 3: {
+                    string phoneNumber, date, time, partySizeInput, tableInput;
+                    int partySize, tableNumber;
+
+                    while (true) {
+                        out << "Enter your phone number (e.g., 123-456-7890): ";
+                        co_await session.readLine(phoneNumber);
+                        if (validatePhoneNumber(phoneNumber)) {
+                            break;
+                        }
+                        out << "Error: Invalid phone number format. Use XXX-XXX-XXXX.\n";
+                        venue()->logError("Customer", username, "Failed to reserve table",
+                                         "Invalid phone number format.", "", username, phoneNumber);
+                    }
+
+                    while (true) {
+                        out << "Enter party size (must be at least 1): ";
+                        co_await session.readLine(partySizeInput);
+                        if (!validateNumericInput(partySizeInput, partySize, 1, INT_MAX)) {
+                            out << "Error: Invalid party size. Must be a single number >= 1 (e.g., 2, not 2a, 2.1, or 2 2).\n";
+                            venue()->logError("Customer", username, "Failed to reserve table",
+                                             "Invalid party size.", "", username, phoneNumber);
+                            continue;
+                        }
+                        if (!validatePartySize(partySize)) {
+                            out << "Error: Party size must be at least 1.\n";
+                            venue()->logError("Customer", username, "Failed to reserve table",
+                                             "Party size must be at least 1.", "", username, phoneNumber, partySize);
+                            continue;
+                        }
+                        break;
+                    }
+
+                    while (true) {
+                        out << "Enter reservation date (e.g., YYYY-MM-DD, must be on or after " << Clock::read().date << "): ";
+                        co_await session.readLine(date);
+                        if (validateDate(date)) {
+                            break;
+                        }
+                        out << "Error: Invalid date format (use YYYY-MM-DD) or date is in the past.\n";
+                        venue()->logError("Customer", username, "Failed to reserve table",
+                                        "Invalid date format or date is in the past.",
+                                        "", username, phoneNumber, partySize, date);
+                    }
+
+                    while (true) {
+                        out << "Enter reservation time (e.g., HH:MM in 24-hour format, must be after "
+                            << Clock::read().timeText() << " if today): ";
+                        co_await session.readLine(time);
+                        if (validateTime(time, date)) {
+                            break;
+                        }
+                        out << "Error: Invalid time format (use HH:MM) or time is in the past for today.\n";
+                        venue()->logError("Customer", username, "Failed to reserve table",
+                                        "Invalid time format or time is in the past.",
+                                        "", username, phoneNumber, partySize, date, time);
+                    }
+
+                    bool reservationComplete = false;
+                    while (!reservationComplete) {
+                        out << "Available tables:\n";
+                        venue()->viewTableAvailability(out);
+                        out << "Enter table number to reserve (1-10, or 0 to cancel): ";
+                        co_await session.readLine(tableInput);
+
+                        if (tableInput == "0") {
+                            out << "Reservation cancelled.\n";
+                            reservationComplete = true;
+                            break;
+                        }
+
+                        if (!validateNumericInput(tableInput, tableNumber, 1, 10)) {
+                            out << "Error: Invalid table number. Must be a single number between 1 and 10 (e.g., 1, not 1a, 1.1, or 1 1).\n";
+                            venue()->logError("Customer", username, "Failed to reserve table",
+                                            "Invalid table number.",
+                                            "", username, phoneNumber, partySize, date, time);
+                            continue;
+                        }
+                        tableNumber--;
+
+                        try {
+                            int table = unlockedVenue().reserveTable(username, phoneNumber, partySize, date, time, tableNumber);
+                            out << "Reserved Table #" << table + 1 << " successfully!\n";
+                            reservationComplete = true;
+                        } catch (const TableUnavailableException& ex) {
+                            out << "Error: Selected table is already booked. Please choose a different table.\n";
+                            out << "Suggestion: " << ex.getSuggestion() << "\n";
+                            venue()->logError("Customer", username, "Failed to reserve table",
+                                            ex.what(), "", username, phoneNumber, partySize, date, time, tableNumber);
+                        } catch (const ReservationException& ex) {
+                            out << "Error: " << ex.what() << "\n";
+                            venue()->logError("Customer", username, "Failed to reserve table",
+                                            ex.what(), "", username, phoneNumber, partySize, date, time, tableNumber);
+                            out << "Reservation failed. Returning to menu.\n";
+                            reservationComplete = true;
+                        }
+                    }
+                    break;
+                }
+                case 4: {
+                    if (!venue()->hasReservations(username)) {
+                        out << "No reservations.\n";
+                        break;
+                    }
+
+                    string reservationId, newId = "0", newName, newPhone, newDate, newTime, newPartySizeInput, newTableChoiceInput;
+                    int newPartySize = 0, newTableChoice = 0, newTableIndex = -1;
+
+                    while (true) {
+                        out << "Enter reservation ID to update (e.g., ID 1A): ";
+                        co_await session.readLine(reservationId);
+                        reservationId = toUpperCase(reservationId);
+                        try {
+                            if (!validateReservationId(reservationId)) {
+                                throw ReservationException("Invalid reservation ID format. Use 'ID <number>A', e.g., ID 1A.");
+                            }
+                            bool hasReservation = false;
+                            vector<Reservation> allRes = venue()->getAllReservations();
+                            for (const auto& res : allRes) {
+                                if (res.id == reservationId && res.customerName == username) {
+                                    hasReservation = true;
+                                    break;
+                                }
+                            }
+                            if (!hasReservation) {
+                                throw ReservationException("No reservation to update.");
+                            }
+                            break;
+                        } catch (const ReservationException& ex) {
+                            out << "Error: " << ex.what() << "\n";
+                            venue()->logError("Customer", username, "Failed to update reservation",
+                                            ex.what(), reservationId, username);
+                        }
+                    }
+
+                    while (true) {
+                        out << "Enter new name (or 0 to keep current): ";
+                        co_await session.readLine(newName);
+                        break;
+                    }
+
+                    while (true) {
+                        out << "Enter new phone number (e.g., 123-456-7890, or 0 to keep current): ";
+                        co_await session.readLine(newPhone);
+                        if (newPhone == "0") break;
+                        if (validatePhoneNumber(newPhone)) break;
+                        out << "Error: Invalid phone number format. Use XXX-XXX-XXXX.\n";
+                        venue()->logError("Customer", username, "Failed to update reservation",
+                                        "Invalid phone number format.", reservationId, username, newPhone);
+                    }
+
+                    while (true) {
+                        out << "Enter new party size (must be at least 1, or 0 to keep current): ";
+                        co_await session.readLine(newPartySizeInput);
+                        if (newPartySizeInput == "0") {
+                            newPartySize = 0;
+                            break;
+                        }
+                        if (!validateNumericInput(newPartySizeInput, newPartySize, 1, INT_MAX)) {
+                            out << "Error: Invalid party size. Must be a single number >= 1 (e.g., 2, not 2a, 2.1, or 2 2).\n";
+                            venue()->logError("Customer", username, "Failed to update reservation",
+                                            "Invalid party size.", reservationId, username, newPhone, newPartySize);
+                            continue;
+                        }
+                        if (!validatePartySize(newPartySize)) {
+                            out << "Error: Party size must be at least 1.\n";
+                            venue()->logError("Customer", username, "Failed to update reservation",
+                                            "Party size must be at least 1.", reservationId, username, newPhone, newPartySize);
+                            continue;
+                        }
+                        break;
+                    }
+
+                    while (true) {
+                        out << "Enter new date (e.g., YYYY-MM-DD, must be on or after " << Clock::read().date << ", or 0 to keep current): ";
+                        co_await session.readLine(newDate);
+                        if (newDate == "0") break;
+                        if (validateDate(newDate)) break;
+                        out << "Error: Invalid date format (use YYYY-MM-DD) or date is in the past.\n";
+                        venue()->logError("Customer", username, "Failed to update reservation",
+                                        "Invalid date format or date is in the past.",
+                                        reservationId, username, newPhone, newPartySize, newDate);
+                    }
+
+                    while (true) {
+                        out << "Enter new time (e.g., HH:MM in 24-hour format, must be after "
+                            << Clock::read().timeText() << " if today, or 0 to keep current): ";
+                        co_await session.readLine(newTime);
+                        if (newTime == "0") break;
+                        if (validateTime(newTime, newDate != "0" ? newDate : Clock::read().date)) break;
+                        out << "Error: Invalid time format (use HH:MM) or time is in the past for today.\n";
+                        venue()->logError("Customer", username, "Failed to update reservation",
+                                        "Invalid time format or time is in the past.",
+                                        reservationId, username, newPhone, newPartySize, newDate, newTime);
+                    }
+
+                    while (true) {
+                        out << "Table options: 0 to keep current, or enter a specific table number (1-10):\n";
+                        venue()->viewTableAvailability(out);
+                        out << "Choice: ";
+                        co_await session.readLine(newTableChoiceInput);
+                        if (!validateNumericInput(newTableChoiceInput, newTableChoice, 0, 10)) {
+                            out << "Error: Invalid table choice. Must be a single number between 0 and 10 (e.g., 1, not 1a, 1.1, or 1 1).\n";
+                            venue()->logError("Customer", username, "Failed to update reservation",
+                                            "Invalid table choice.",
+                                            reservationId, username, newPhone, newPartySize, newDate, newTime);
+                            continue;
+                        }
+                        break;
+                    }
+
+                    string confirm;
+                    out << "Confirm update? (Y/N or Yes/No): ";
+                    co_await session.readLine(confirm);
+                    if (confirm != "Yes" && confirm != "yes" && confirm != "Y" && confirm != "y") {
+                        out << "Update cancelled.\n";
+                        break;
+                    }
+
+                    try {
+                        if (newTableChoice != 0) {
+                            newTableIndex = newTableChoice - 1;
+                        }
+                        venue()->updateReservation(reservationId, username,
+                                                   newId, newName, newPhone, newPartySize,
+                                                   newDate, newTime, newTableIndex);
+                        out << "Reservation updated successfully.\n";
+                    } catch (const ReservationException& ex) {
+                        out << "Error: " << ex.what() << "\n";
+                        if (const auto* unavailable = dynamic_cast<const TableUnavailableException*>(&ex)) {
+                            out << "Suggestion: " << unavailable->getSuggestion() << "\n";
+                        }
+                        venue()->logError("Customer", username, "Failed to update reservation",
+                                        ex.what(), reservationId, username, newPhone, newPartySize, newDate, newTime, newTableIndex);
+                        out << "Update failed. Returning to menu.\n";
+                    }
+                    break;
+                }
+                case 5: {
+                    if (!venue()->hasReservations(username)) {
+                        out << "No reservations.\n";
+                        break;
+                    }
+
+                    bool processComplete = false;
+                    string reservationId;
+                    while (!processComplete) {
+                        try {
+                            out << "Enter reservation ID to cancel (e.g., ID 1A): ";
+                            co_await session.readLine(reservationId);
+                            reservationId = toUpperCase(reservationId);
+
+                            venue()->viewCustomerReservations(out, username);
+
+                            string confirm;
+                            out << "Confirm cancellation? (Y/N or Yes/No): ";
+                            co_await session.readLine(confirm);
+                            if (confirm != "Yes" && confirm != "yes" && confirm != "Y" && confirm != "y") {
+                                out << "Cancellation aborted.\n";
+                                processComplete = true;
+                                break;
+                            }
+
+                            venue()->cancelReservation(reservationId, username);
+                            out << "Reservation cancelled.\n";
+                            processComplete = true;
+                        } catch (const ReservationException& ex) {
+                            out << "Error: " << ex.what() << "\n";
+                            venue()->logError("Customer", username, "Failed to cancel reservation",
+                                            ex.what(), reservationId, username);
+                            out << "Please try again.\n";
+                        }
+                    }
+                    break;
+                }
+                case 6: {
+                    string logout;
+                    out << "Logout? (Y/N or Yes/No): ";
+                    co_await session.readLine(logout);
+                    if (logout == "Yes" || logout == "yes" || logout == "Y" || logout == "y") {
+                        co_return true;
+                    }
+                    break;
+                }
+                case 7: {
+                    string date;
+                    out << "Enter date (YYYY-MM-DD, or 0 for " << Clock::read().date << "): ";
+                    co_await session.readLine(date);
+                    if (date == "0") {
+                        date = Clock::read().date;
+                    }
+                    if (!validateDateFormat(date)) {
+                        out << "Error: Invalid date format. Use YYYY-MM-DD.\n";
+                        break;
+                    }
+                    auto heatmap = [date](const ReservationManager& shard) {
+                        ostringstream text;
+                        shard.viewAvailabilityHeatmap(text, date);
+                        return text.str();
+                    };
+                    out << co_await session.read(venueId, heatmap);
+                    break;
+                }
+            }
+        }
+        co_return false;
+    }
+};
+
+class Receptionist : public User {
+public:
+    bool isValidCredential(const string& input) const {
+        return !input.empty() && all_of(input.begin(), input.end(), [](char c) {
+            return isalnum(c);
+        });
+    }
+
+public:
+    Receptionist(const string& name, const string& password, const string& venue)
+        : User(name, "Receptionist", password, venue) {}
+    Task<bool> showMenu(Session& session) override {
+        ostream& out = session.out();
+        bool isRunning = true;
+        while (isRunning) {
+            string input;
+            int choice;
+            out << "\n[Receptionist Menu - " << username << "]\n";
+            out << "1. View Reservations\n2. View Table Availability\n4. Find Reservations by Phone\n"
+                << "5. Search Customers by Name\n6. View Day Sheet\n7. View Availability by Time\n8. Check In Guest\n"
+                << "3. Exit\nChoice: ";
+            co_await session.readLine(input);
+
+            if (!validateNumericInput(input, choice, 1, 8)) {
+                out << "Invalid choice. Please enter a single number between 1 and 8.\n";
+                continue;
+            }
+
+            switch (choice) {
+                case 1: {
+                    out << "\n--- Current Reservations ---\n";
+                    auto listing = [](const ReservationManager& shard) { return shard.getAllReservations(); };
+                    vector<Reservation> allReservations = co_await session.read(venueId, listing);
+                    if (allReservations.empty()) {
+                        out << "No reservations found.\n";
+                    } else {
+                        out << "ID\t\tCustomer\tParty\tDate\t\tTime\tContact\t\tTable\n";
+                        for (const auto& res : allReservations) {
+                            out << res.id << "\t"
+                                << res.customerName << "\t"
+                                << res.partySize << "\t"
+                                << res.date << "\t"
+                                << res.time << "\t"
+                                << res.phoneNumber << "\t"
+                                << (res.tableNumber + 1) << "\n";
+                        }
+                    }
+                    break;
+                }
+                case 2:
+                    venue()->viewTableAvailability(out);
+                    break;
+                case 3: {
+                    string logout;
+                    out << "Logout? (Y/N or Yes/No): ";
+                    co_await session.readLine(logout);
+                    if (logout == "Yes" || logout == "yes" || logout == "Y" || logout == "y") {
+                        co_return true;
+                    }
+                    break;
+                }
+                case 4: {
+                    string phoneNumber;
+                    out << "Enter caller's phone number (e.g., 123-456-7890): ";
+                    co_await session.readLine(phoneNumber);
+                    if (!validatePhoneNumber(phoneNumber)) {
+                        out << "Error: Invalid phone number format. Use XXX-XXX-XXXX.\n";
+                        break;
+                    }
+                    auto byPhone = [phoneNumber](const ReservationManager& shard) {
+                        return shard.findReservationsByPhone(phoneNumber);
+                    };
+                    vector<Reservation> matches = co_await session.read(venueId, byPhone);
+                    if (matches.empty()) {
+                        out << "No reservations found for " << phoneNumber << ".\n";
+                    } else {
+                        out << "\n--- Reservations for " << phoneNumber << " ---\n";
+                        out << "ID\t\tCustomer\tParty\tDate\t\tTime\tContact\t\tTable\n";
+                        for (const auto& res : matches) {
+                            out << res.id << "\t"
+                                << res.customerName << "\t"
+                                << res.partySize << "\t"
+                                << res.date << "\t"
+                                << res.time << "\t"
+                                << res.phoneNumber << "\t"
+                                << (res.tableNumber + 1) << "\n";
+                        }
+                    }
+                    break;
+                }
+                case 5: {
+                    string query;
+                    out << "Enter customer name or the start of it: ";
+                    co_await session.readLine(query);
+                    if (query.empty()) {
+                        out << "Error: Name cannot be empty.\n";
+                        break;
+                    }
+                    auto byName = [query](const ReservationManager& shard) {
+                        vector<Reservation> found; // best matches first
+                        for (const auto& match : shard.searchCustomersByName(query)) {
+                            for (const auto& id : match.ids) {
+                                found.push_back(shard.getReservation(id));
+                            }
+                        }
+                        return found;
+                    };
+                    vector<Reservation> matches = co_await session.read(venueId, byName);
+                    if (matches.empty()) {
+                        out << "No customers match \"" << query << "\".\n";
+                        break;
+                    }
+                    out << "\n--- Customers matching \"" << query << "\" ---\n";
+                    out << "ID\t\tCustomer\tParty\tDate\t\tTime\tContact\t\tTable\n";
+                    for (const auto& res : matches) {
+                        out << res.id << "\t"
+                            << res.customerName << "\t"
+                            << res.partySize << "\t"
+                            << res.date << "\t"
+                            << res.time << "\t"
+                            << res.phoneNumber << "\t"
+                            << (res.tableNumber + 1) << "\n";
+                    }
+                    break;
+                }
+                case 6: {
+                    string fromDate, toDate;
+                    out << "Enter date (YYYY-MM-DD, or 0 for " << Clock::read().date << "): ";
+                    co_await session.readLine(fromDate);
+                    if (fromDate == "0") {
+                        fromDate = Clock::read().date;
+                    }
+                    if (!validateDateFormat(fromDate)) {
+                        out << "Error: Invalid date format. Use YYYY-MM-DD.\n";
+                        break;
+                    }
+                    out << "Enter end date for a range (YYYY-MM-DD, or 0 for the same day): ";
+                    co_await session.readLine(toDate);
+                    if (toDate == "0") {
+                        toDate = fromDate;
+                    }
+                    if (!validateDateFormat(toDate) || toDate < fromDate) {
+                        out << "Error: End date must be in YYYY-MM-DD format and not before " << fromDate << ".\n";
+                        break;
+                    }
+                    auto daySheet = [fromDate, toDate](const ReservationManager& shard) {
+                        return shard.getReservationsBetween(fromDate, toDate);
+                    };
+                    vector<Reservation> sheet = co_await session.read(venueId, daySheet);
+                    out << "\n--- Service Sheet: " << fromDate << (toDate != fromDate ? " to " + toDate : "") << " ---\n";
+                    if (sheet.empty()) {
+                        out << "No reservations found.\n";
+                        break;
+                    }
+                    out << "Date\t\tTime\tTable\tParty\tCustomer\tContact\t\tID\n";
+                    for (const auto& res : sheet) {
+                        out << res.date << "\t"
+                            << res.time << "\t"
+                            << (res.tableNumber + 1) << "\t"
+                            << res.partySize << "\t"
+                            << res.customerName << "\t"
+                            << res.phoneNumber << "\t"
+                            << res.id << "\n";
+                    }
+                    break;
+                }
+                case 7: {
+                    string date;
+                    out << "Enter date (YYYY-MM-DD, or 0 for " << Clock::read().date << "): ";
+                    co_await session.readLine(date);
+                    if (date == "0") {
+                        date = Clock::read().date;
+                    }
+                    if (!validateDateFormat(date)) {
+                        out << "Error: Invalid date format. Use YYYY-MM-DD.\n";
+                        break;
+                    }
+                    auto heatmap = [date](const ReservationManager& shard) {
+                        ostringstream text;
+                        shard.viewAvailabilityHeatmap(text, date);
+                        return text.str();
+                    };
+                    out << co_await session.read(venueId, heatmap);
+                    break;
+                }
+                case 8: {
+                    string reservationId;
+                    out << "Enter reservation ID to check in (e.g., ID 1A): ";
+                    co_await session.readLine(reservationId);
+                    reservationId = toUpperCase(reservationId);
+                    try {
+                        if (!validateReservationId(reservationId)) {
+                            throw ReservationException("Invalid reservation ID format. Use 'ID <number>A', e.g., ID 1A.");
+                        }
+                        if (venue()->checkIn(reservationId, username)) {
+                            out << "Checked in " << reservationId << ". The table will not be released as a no-show.\n";
+                        } else {
+                            out << "Checked in " << reservationId << ".\n";
+                        }
+                    } catch (const ReservationException& ex) {
+                        out << "Error: " << ex.what() << "\n";
+                    }
+                    break;
+                }
+            }
+        }
+        co_return false;
+    }
+};
+
+class Admin : public User {
+public:
+    Admin(const string& name, const string& password, const string& venue) : User(name, "Admin", password, venue) {}
+    Task<bool> showMenu(Session& session) override {
+        ostream& out = session.out();
+        bool isRunning = true;
+        while (isRunning) {
+            string input;
+            int choice;
+            out << "\n[Admin Menu - " << username << "]\n";
+            out << "1. View Logs\n";
+            out << "2. View Customer Reservations\n";
+            out << "3. View Table Availability\n";
+            out << "4. Update Reservation\n";
+            out << "5. Cancel Reservation\n";
+            out << "6. Create Receptionist Account\n";
+            out << "8. View System Metrics\n";
+            out << "9. Run Maintenance Now\n";
+            out << "10. Search All Venues\n";
+            out << "11. View Memory Usage\n";
+            out << "12. View Lock Contention\n";
+            out << "7. Log Out\nChoice: ";
+            co_await session.readLine(input);
+
+            if (!validateNumericInput(input, choice, 1, 12)) {
+                out << "Invalid choice. Please enter a single number between 1 and 12.\n";
+                continue;
+            }
+
+            switch (choice) {
                 case 1:
-                    ReservationManager::getInstance().viewCustomerReservations(username);
+                    venue()->viewLogs(out);
                     break;
-                case 2:
-                    ReservationManager::getInstance().viewTableAvailability();
+                case 2: {
+                    out << "\n--- Current Reservations ---\n";
+                    auto listing = [](const ReservationManager& shard) { return shard.getAllReservations(); };
+                    vector<Reservation> allReservations = co_await session.read(venueId, listing);
+                    if (allReservations.empty()) {
+                        out << "No reservations found.\n";
+                    } else {
+                        out << "ID\t\tCustomer\tParty\tDate\t\tTime\tContact\t\tTable\n";
+                        for (const auto& res : allReservations) {
+                            out << res.id << "\t"
+                                << res.customerName << "\t"
+                                << res.partySize << "\t"
+                                << res.date << "\t"
+                                << res.time << "\t"
+                                << res.phoneNumber << "\t"
+                                << (res.tableNumber + 1) << "\n";
+                        }
+                    }
                     break;
-                case 3: {
-                    string phoneNumber, date, time, partySizeInput, tableInput;
-                    int partySize, tableNumber;
+                }
+                case 3:
+                    venue()->viewTableAvailability(out);
+                    break;
+                case 4: {
+                    vector<Reservation> allReservations = venue()->getAllReservations();
+                    if (allReservations.empty()) {
+                        out << "No reservations.\n";
+                        break;
+                    }
+
+                    string reservationId, newId, newName, newPhone, newDate, newTime, newPartySizeInput, newTableChoiceInput;
+                    int newPartySize = 0, newTableChoice = 0, newTableIndex = -1;
+                    string customerName;
+
+                    while (true) {
+                        out << "Enter reservation ID to update (e.g., ID 1A): ";
+                        co_await session.readLine(reservationId);
+                        reservationId = toUpperCase(reservationId);
+                        try {
+                            if (!validateReservationId(reservationId)) {
+                                throw ReservationException("Invalid reservation ID format. Use 'ID <number>A', e.g., ID 1A.");
+                            }
+                            bool hasReservation = false;
+                            for (const auto& res : allReservations) {
+                                if (res.id == reservationId) {
+                                    hasReservation = true;
+                                    customerName = res.customerName;
+                                    break;
+                                }
+                            }
+                            if (!hasReservation) {
+                                throw ReservationException("Reservation ID not found.");
+                            }
+                            out << "\n--- Reservation to Update ---\n";
+                            out << "ID\t\tCustomer\tParty\tDate\t\tTime\tContact\t\tTable\n";
+                            for (const auto& res : allReservations) {
+                                if (res.id == reservationId) {
+                                    out << res.id << "\t"
+                                        << res.customerName << "\t"
+                                        << res.partySize << "\t"
+                                        << res.date << "\t"
+                                        << res.time << "\t"
+                                        << res.phoneNumber << "\t"
+                                        << (res.tableNumber + 1) << "\n";
+                                    break;
+                                }
+                            }
+                            break;
+                        } catch (const ReservationException& ex) {
+                            out << "Error: " << ex.what() << "\n";
+                            venue()->logError("Admin", username, "Failed to update reservation",
+                                            ex.what(), reservationId);
+                        }
+                    }
+
+                    while (true) {
+                        out << "Enter new ID (e.g., ID 2A, or 0 to keep current): ";
+                        co_await session.readLine(newId);
+                        newId = toUpperCase(newId);
+                        if (newId == "0") break;
+                        try {
+                            if (!validateReservationId(newId)) {
+                                throw ReservationException("Invalid new reservation ID format. Use 'ID <number>A', e.g., ID 1A.");
+                            }
+                            if (venue()->reservationIdExists(newId, reservationId)) {
+                                throw ReservationException("New reservation ID already exists. Choose a different ID.");
+                            }
+                            break;
+                        } catch (const ReservationException& ex) {
+                            out << "Error: " << ex.what() << "\n";
+                            venue()->logError("Admin", username, "Failed to update reservation",
+                                            ex.what(), reservationId);
+                        }
+                    }
+
+                    while (true) {
+                        out << "Enter new name (or 0 to keep current): ";
+                        co_await session.readLine(newName);
+                        break;
+                    }
+
+                    while (true) {
+                        out << "Enter new phone number (e.g., 123-456-7890, or 0 to keep current): ";
+                        co_await session.readLine(newPhone);
+                        if (newPhone == "0") break;
+                        if (validatePhoneNumber(newPhone)) break;
+                        out << "Error: Invalid phone number format. Use XXX-XXX-XXXX.\n";
+                        venue()->logError("Admin", username, "Failed to update reservation",
+                                        "Invalid phone number format.", reservationId, newName, newPhone);
+                    }
+
+                    while (true) {
+                        out << "Enter new party size (must be at least 1, or 0 to keep current): ";
+                        co_await session.readLine(newPartySizeInput);
+                        if (newPartySizeInput == "0") {
+                            newPartySize = 0;
+                            break;
+                        }
+                        if (!validateNumericInput(newPartySizeInput, newPartySize, 1, INT_MAX)) {
+                            out << "Error: Invalid party size. Must be a single number >= 1 (e.g., 2, not 2a, 2.1, or 2 2).\n";
+                            venue()->logError("Admin", username, "Failed to update reservation",
+                                            "Invalid party size.", reservationId, newName, newPhone, newPartySize);
+                            continue;
+                        }
+                        if (!validatePartySize(newPartySize)) {
+                            out << "Error: Party size must be at least 1.\n";
+                            venue()->logError("Admin", username, "Failed to update reservation",
+                                            "Party size must be at least 1.", reservationId, newName, newPhone, newPartySize);
+                            continue;
+                        }
+                        break;
+                    }
+
+                    while (true) {
+                        out << "Enter new date (e.g., YYYY-MM-DD, must be on or after " << Clock::read().date << ", or 0 to keep current): ";
+                        co_await session.readLine(newDate);
+                        if (newDate == "0") break;
+                        if (validateDate(newDate)) break;
+                        out << "Error: Invalid date format (use YYYY-MM-DD) or date is in the past.\n";
+                        venue()->logError("Admin", username, "Failed to update reservation",
+                                        "Invalid date format or date is in the past.",
+                                        reservationId, newName, newPhone, newPartySize, newDate);
+                    }
+
+                    while (true) {
+                        out << "Enter new time (e.g., HH:MM in 24-hour format, must be after "
+                            << Clock::read().timeText() << ", or 0 to keep current): ";
+                        co_await session.readLine(newTime);
+                        if (newTime == "0") break;
+                        if (validateTime(newTime, newDate != "0" ? newDate : Clock::read().date)) break;
+                        out << "Error: Invalid time format (use HH:MM) or time is in the past for today.\n";
+                        venue()->logError("Admin", username, "Failed to update reservation",
+                                        "Invalid time format or time is in the past.",
+                                        reservationId, newName, newPhone, newPartySize, newDate, newTime);
+                    }
+
+                    while (true) {
+                        out << "Table options: 0 to keep current, or enter a specific table number (1-10):\n";
+                        venue()->viewTableAvailability(out);
+                        out << "Choice: ";
+                        co_await session.readLine(newTableChoiceInput);
+                        if (!validateNumericInput(newTableChoiceInput, newTableChoice, 0, 10)) {
+                            out << "Error: Invalid table choice. Must be a single number between 0 and 10 (e.g., 1, not 1a, 1.1, or 1 1).\n";
+                            venue()->logError("Admin", username, "Failed to update reservation",
+                                            "Invalid table choice.",
+                                            reservationId, newName, newPhone, newPartySize, newDate, newTime);
+                            continue;
+                        }
+                        break;
+                    }
+
+                    string confirm;
+                    out << "Confirm update? (Y/N or Yes/No): ";
+                    co_await session.readLine(confirm);
+                    if (confirm != "Yes" && confirm != "yes" && confirm != "Y" && confirm != "y") {
+                        out << "Update cancelled.\n";
+                        break;
+                    }
+
+                    try {
+                        if (newTableChoice != 0) {
+                            newTableIndex = newTableChoice - 1;
+                        }
+                        venue()->updateReservation(reservationId, customerName,
+                                                   newId, newName, newPhone, newPartySize,
+                                                   newDate, newTime, newTableIndex);
+                        out << "Reservation updated successfully.\n";
+                        venue()->logReservationAction("Admin", username, "Updated reservation",
+                                                    "ID " + reservationId);
+                    } catch (const ReservationException& ex) {
+                        out << "Error: " << ex.what() << "\n";
+                        if (const auto* unavailable = dynamic_cast<const TableUnavailableException*>(&ex)) {
+                            out << "Suggestion: " << unavailable->getSuggestion() << "\n";
+                        }
+                        venue()->logError("Admin", username, "Failed to update reservation",
+                                        ex.what(), reservationId, newName, newPhone, newPartySize, newDate, newTime, newTableIndex);
+                        out << "Update failed. Returning to menu.\n";
+                    }
+                    break;
+                }
+                case 5: {
+                    vector<Reservation> allReservations = venue()->getAllReservations();
+                    if (allReservations.empty()) {
+                        out << "No reservations.\n";
+                        break;
+                    }
+
+                    bool processComplete = false;
+                    string reservationId;
+                    while (!processComplete) {
+                        try {
+                            string customerName;
+                            out << "Enter reservation ID to cancel (e.g., ID 1A): ";
+                            co_await session.readLine(reservationId);
+                            reservationId = toUpperCase(reservationId);
+
+                            if (!validateReservationId(reservationId)) {
+                                throw ReservationException("Invalid reservation ID format. Use 'ID <number>A', e.g., ID 1A.");
+                            }
+                            bool found = false;
+                            for (const auto& res : allReservations) {
+                                if (res.id == reservationId) {
+                                    customerName = res.customerName;
+                                    found = true;
+                                    break;
+                                }
+                            }
+                            if (!found) {
+                                throw ReservationException("Reservation ID not found.");
+                            }
+
+                            out << "\n--- Reservation to Cancel ---\n";
+                            out << "ID\t\tCustomer\tParty\tDate\t\tTime\tContact\t\tTable\n";
+                            for (const auto& res : allReservations) {
+                                if (res.id == reservationId) {
+                                    out << res.id << "\t"
+                                        << res.customerName << "\t"
+                                        << res.partySize << "\t"
+                                        << res.date << "\t"
+                                        << res.time << "\t"
+                                        << res.phoneNumber << "\t"
+                                        << (res.tableNumber + 1) << "\n";
+                                    break;
+                                }
+                            }
+
+                            string confirm;
+                            out << "Confirm cancellation? (Y/N or Yes/No): ";
+                            co_await session.readLine(confirm);
+                            if (confirm != "Yes" && confirm != "yes" && confirm != "Y" && confirm != "y") {
+                                out << "Cancellation aborted.\n";
+                                processComplete = true;
+                                break;
+                            }
+
+                            venue()->cancelReservation(reservationId, customerName);
+                            out << "Reservation cancelled.\n";
+                            venue()->logReservationAction("Admin", username, "Cancelled reservation",
+                                                        "ID " + reservationId);
+                            processComplete = true;
+                        } catch (const ReservationException& ex) {
+                            out << "Error: " << ex.what() << "\n";
+                            venue()->logError("Admin", username, "Failed to cancel reservation",
+                                            ex.what(), reservationId);
+                            out << "Please try again.\n";
+                        }
+                    }
+                    break;
+                }
+                case 6: {
+                    string recUsername, recPassword;
+                    bool usernameValid = false;
+                    while (!usernameValid) {
+                        out << "Enter new receptionist username (no spaces allowed): ";
+                        co_await session.readLine(recUsername);
+                        if (!isValidCredential(recUsername)) {
+                            out << "Error: Username cannot be empty or contain spaces.\n";
+                            continue;
+                        }
+                        if (receptionistAccounts.count(recUsername)) {
+                            out << "Username already exists. Please choose a different username.\n";
+                            continue;
+                        }
+                        usernameValid = true;
+                    }
+                    bool passwordValid = false;
+                    while (!passwordValid) {
+                        out << "Enter password (no spaces allowed): ";
+                        co_await session.readLine(recPassword);
+                        if (!isValidCredential(recPassword)) {
+                            out << "Error: Password cannot be empty or contain spaces.\n";
+                            continue;
+                        }
+                        passwordValid = true;
+                    }
+                    receptionistAccounts[recUsername] = recPassword;
+                    out << "Receptionist account created.\n";
+                    venue()->logReservationAction("Admin", username, "Created receptionist account",
+                                                "Username: " + recUsername);
+                    break;
+                }
+                case 7: {
+                    string logout;
+                    out << "Logout? (Y/N or Yes/No): ";
+                    co_await session.readLine(logout);
+                    if (logout == "Yes" || logout == "yes" || logout == "Y" || logout == "y") {
+                        co_return true;
+                    }
+                    break;
+                }
+                case 8:
+                    out << "\n--- System Metrics ---\n";
+                    Instrumentation::report(out);
+                    try {
+                        Instrumentation::writeMetricsFile();
+                        out << "Saved to metrics.txt.\n";
+                    } catch (const ReservationException& ex) {
+                        out << "Error: " << ex.what() << "\n";
+                    }
+                    break;
+                case 9:
+                    venue()->scheduleMaintenance();
+                    out << "Snapshot, checksum scrub and report queued in the background.\n";
+                    venue()->logReservationAction("Admin", username, "Queued maintenance",
+                                                "Snapshot, scrub and report");
+                    break;
+                case 10: {
+                    string query;
+                    out << "Enter phone number or customer name: ";
+                    co_await session.readLine(query);
+                    if (query.empty()) {
+                        out << "Error: Search cannot be empty.\n";
+                        break;
+                    }
+                    bool byPhone = validatePhoneNumber(query);
+                    auto results = VenueRegistry::getInstance().queryAllVenues<vector<Reservation>>(
+                        [&query, byPhone](const ReservationManager& shard) {
+                            if (byPhone) {
+                                return shard.findReservationsByPhone(query);
+                            }
+                            vector<Reservation> matches;
+                            for (const auto& match : shard.searchCustomersByName(query)) {
+                                for (const auto& id : match.ids) {
+                                    matches.push_back(shard.getReservation(id));
+                                }
+                            }
+                            return matches;
+                        });
+                    bool found = false;
+                    for (const auto& result : results) {
+                        if (result.second.empty()) {
+                            continue;
+                        }
+                        found = true;
+                        out << "\n--- Venue " << result.first << " ---\n";
+                        out << "ID\t\tCustomer\tParty\tDate\t\tTime\tContact\t\tTable\n";
+                        for (const auto& res : result.second) {
+                            out << res.id << "\t"
+                                << res.customerName << "\t"
+                                << res.partySize << "\t"
+                                << res.date << "\t"
+                                << res.time << "\t"
+                                << res.phoneNumber << "\t"
+                                << (res.tableNumber + 1) << "\n";
+                        }
+                    }
+                    if (!found) {
+                        out << "No reservations match \"" << query << "\" at any venue.\n";
+                    }
+                    break;
+                }
+                case 11:
+                    out << "\n--- Memory Usage ---\n";
+                    MemoryAccounting::report(out);
+                    break;
+                case 12:
+                    out << "\n--- Lock Contention (most waited-on first) ---\n";
+                    LockProfiler::report(out, 10);
+                    break;
+            }
+        }
+        co_return false;
+    }
+};
+
+// -------- HTTP API --------
+// JSON endpoints over the same venue shards the menus use, for the web booking widget:
+//   GET    /venues
+//   GET    /reservations?venue=&date=&to=&phone=&name=   listing, day sheet or search
+//   GET    /reservations/{id}                            lookup
+//   POST   /reservations                                 reserve
+//   PATCH  /reservations/{id}                            update (only the fields sent)
+//   DELETE /reservations/{id}                            cancel
+//   POST   /reservations/{id}/check-in                   guest arrived, stops the no-show release
+//   GET    /availability?venue=&date=
+// Without ?venue= the default venue is used. Ids are sent URL-encoded ("ID%201A").
+string reservationJson(const Reservation& res) {
+    ostringstream json;
+    json << "{\"id\":\"" << jsonEscape(res.id) << "\",\"name\":\"" << jsonEscape(res.customerName)
+         << "\",\"phone\":\"" << jsonEscape(res.phoneNumber) << "\",\"partySize\":" << res.partySize
+         << ",\"date\":\"" << res.date << "\",\"time\":\"" << res.time << "\",\"table\":" << res.tableNumber + 1 << "}";
+    return json.str();
+}
+
+string reservationsJson(const vector<Reservation>& list) {
+    string json = "[";
+    for (size_t i = 0; i < list.size(); ++i) {
+        json += (i ? "," : "") + reservationJson(list[i]);
+    }
+    return json + "]";
+}
+
+// Flat JSON objects only ({"name":"Ann","partySize":4}); values come back as text.
+bool parseJsonObject(const string& body, map<string, string>& fields) {
+    size_t pos = 0;
+    auto skipSpace = [&] {
+        while (pos < body.size() && isspace(static_cast<unsigned char>(body[pos]))) {
+            pos++;
+        }
+    };
+    auto readString = [&](string& out) {
+        if (pos >= body.size() || body[pos] != '"') {
+            return false;
+        }
+        for (pos++; pos < body.size() && body[pos] != '"'; pos++) {
+            if (body[pos] == '\\' && pos + 1 < body.size()) {
+                char escaped = body[++pos];
+                out += escaped == 'n' ? '\n' : escaped == 't' ? '\t' : escaped == 'r' ? '\r' : escaped;
+            } else {
+                out += body[pos];
+            }
+        }
+        return pos++ < body.size();
+    };
+
+    skipSpace();
+    if (pos >= body.size() || body[pos++] != '{') {
+        return false;
+    }
+    skipSpace();
+    if (pos < body.size() && body[pos] == '}') {
+        return true;
+    }
+    while (true) {
+        string key, value;
+        skipSpace();
+        if (!readString(key)) {
+            return false;
+        }
+        skipSpace();
+        if (pos >= body.size() || body[pos++] != ':') {
+            return false;
+        }
+        skipSpace();
+        if (pos < body.size() && body[pos] == '"') {
+            if (!readString(value)) {
+                return false;
+            }
+        } else {
+            while (pos < body.size() && body[pos] != ',' && body[pos] != '}' && !isspace(static_cast<unsigned char>(body[pos]))) {
+                value += body[pos++];
+            }
+            if (value.empty()) {
+                return false;
+            }
+        }
+        fields[key] = value;
+        skipSpace();
+        if (pos < body.size() && body[pos] == ',') {
+            pos++;
+            continue;
+        }
+        return pos < body.size() && body[pos] == '}';
+    }
+}
+
+string percentDecode(const string& text, bool plusIsSpace) {
+    string decoded;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '%' && i + 2 < text.size() && isxdigit(text[i + 1]) && isxdigit(text[i + 2])) {
+            decoded += static_cast<char>(stoi(text.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else {
+            decoded += plusIsSpace && text[i] == '+' ? ' ' : text[i];
+        }
+    }
+    return decoded;
+}
+
+struct HttpRequest {
+    string method;
+    string path;
+    map<string, string> query;
+    map<string, string> headers; // names lower-cased
+    string body;
+    string client; // X-Client-Id, else the peer address
+    bool keepAlive = true;
+};
+
+struct HttpResponse {
+    int status = 200;
+    string body;
+    int retryAfterSeconds = 0;
+
+    static HttpResponse json(int status, const string& body) {
+        HttpResponse response;
+        response.status = status;
+        response.body = body;
+        return response;
+    }
+
+    static HttpResponse error(int status, const string& message) {
+        return json(status, "{\"error\":\"" + jsonEscape(message) + "\"}");
+    }
+
+    static const char* reason(int status) {
+        switch (status) {
+            case 200: return "OK";
+            case 201: return "Created";
+            case 400: return "Bad Request";
+            case 404: return "Not Found";
+            case 405: return "Method Not Allowed";
+            case 409: return "Conflict";
+            case 411: return "Length Required";
+            case 413: return "Payload Too Large";
+            case 429: return "Too Many Requests";
+            case 431: return "Request Header Fields Too Large";
+            case 503: return "Service Unavailable";
+            default: return "Internal Server Error";
+        }
+    }
+
+    string serialize(bool keepAlive) const {
+        ostringstream out;
+        out << "HTTP/1.1 " << status << " " << reason(status) << "\r\n"
+            << "Content-Type: application/json\r\n"
+            << "Content-Length: " << body.size() << "\r\n"
+            << "Connection: " << (keepAlive ? "keep-alive" : "close") << "\r\n";
+        if (retryAfterSeconds > 0) {
+            out << "Retry-After: " << retryAfterSeconds << "\r\n";
+        }
+        out << "\r\n" << body;
+        return out.str();
+    }
+};
+
+class HttpApi {
+private:
+    static bool readInt(const map<string, string>& fields, const string& key, int& value) {
+        auto it = fields.find(key);
+        return it != fields.end() && validateNumericInput(it->second, value, INT_MIN, INT_MAX);
+    }
+
+    static string field(const map<string, string>& fields, const string& key, const string& missing = "") {
+        auto it = fields.find(key);
+        return it == fields.end() ? missing : it->second;
+    }
+
+    static HttpResponse listReservations(ReservationManager& manager, const HttpRequest& request) {
+        auto shard = manager.access();
+        string phone = field(request.query, "phone");
+        string name = field(request.query, "name");
+        string date = field(request.query, "date");
+        if (!phone.empty()) {
+            return HttpResponse::json(200, reservationsJson(shard->findReservationsByPhone(phone)));
+        }
+        if (!name.empty()) {
+            vector<Reservation> found;
+            for (const auto& match : shard->searchCustomersByName(name)) {
+                for (const auto& id : match.ids) {
+                    found.push_back(shard->getReservation(id));
+                }
+            }
+            return HttpResponse::json(200, reservationsJson(found));
+        }
+        if (!date.empty()) {
+            string to = field(request.query, "to", date);
+            if (!validateDateFormat(date) || !validateDateFormat(to)) {
+                return HttpResponse::error(400, "Invalid date format. Use YYYY-MM-DD.");
+            }
+            return HttpResponse::json(200, reservationsJson(shard->getReservationsBetween(date, to)));
+        }
+        return HttpResponse::json(200, reservationsJson(shard->getAllReservations()));
+    }
+
+    static HttpResponse reserve(ReservationManager& manager, const HttpRequest& request) {
+        map<string, string> fields;
+        int partySize, table;
+        if (!parseJsonObject(request.body, fields)) {
+            return HttpResponse::error(400, "Body must be a JSON object.");
+        }
+        if (!readInt(fields, "partySize", partySize) || !readInt(fields, "table", table)) {
+            return HttpResponse::error(400, "partySize and table must be whole numbers.");
+        }
+        string name = field(fields, "name");
+        if (name.empty()) {
+            return HttpResponse::error(400, "name is required.");
+        }
+        Reservation booked;
+        manager.reserveTable(name, field(fields, "phone"), partySize, field(fields, "date"), field(fields, "time"),
+                             table - 1, &booked);
+        return HttpResponse::json(201, reservationJson(booked));
+    }
+
+    static HttpResponse update(ReservationManager& manager, const string& id, const HttpRequest& request) {
+        map<string, string> fields;
+        if (!parseJsonObject(request.body, fields)) {
+            return HttpResponse::error(400, "Body must be a JSON object.");
+        }
+        int partySize = 0, table = 0;
+        if ((fields.count("partySize") && !readInt(fields, "partySize", partySize))
+            || (fields.count("table") && !readInt(fields, "table", table))) {
+            return HttpResponse::error(400, "partySize and table must be whole numbers.");
+        }
+        if (fields.count("table") && table < 1) {
+            return HttpResponse::error(400, "Invalid table number. Must be between 1 and 10.");
+        }
+        auto shard = manager.access();
+        if (!shard->reservationIdExists(id)) {
+            return HttpResponse::error(404, "Reservation ID not found.");
+        }
+        string newId = field(fields, "id", "0");
+        shard->updateReservation(id, shard->getReservation(id).customerName, newId, field(fields, "name", "0"),
+                                 field(fields, "phone", "0"), partySize, field(fields, "date", "0"),
+                                 field(fields, "time", "0"), fields.count("table") ? table - 1 : -1);
+        return HttpResponse::json(200, reservationJson(shard->getReservation(newId == "0" ? id : newId)));
+    }
+
+    static HttpResponse cancel(ReservationManager& manager, const string& id) {
+        auto shard = manager.access();
+        if (!shard->reservationIdExists(id)) {
+            return HttpResponse::error(404, "Reservation ID not found.");
+        }
+        string upperId = toUpperCase(id);
+        shard->cancelReservation(upperId, shard->getReservation(upperId).customerName);
+        return HttpResponse::json(200, "{\"cancelled\":\"" + jsonEscape(upperId) + "\"}");
+    }
+
+    static HttpResponse checkIn(ReservationManager& manager, const string& id) {
+        auto shard = manager.access();
+        if (!shard->reservationIdExists(id)) {
+            return HttpResponse::error(404, "Reservation ID not found.");
+        }
+        string upperId = toUpperCase(id);
+        bool noShowCancelled = shard->checkIn(upperId, "web");
+        return HttpResponse::json(200, "{\"checkedIn\":\"" + jsonEscape(upperId) + "\",\"noShowCancelled\":"
+                                           + (noShowCancelled ? "true" : "false") + "}");
+    }
+
+    static HttpResponse availability(ReservationManager& manager, const HttpRequest& request) {
+        string date = field(request.query, "date", Clock::read().date);
+        if (!validateDateFormat(date)) {
+            return HttpResponse::error(400, "Invalid date format. Use YYYY-MM-DD.");
+        }
+        auto shard = manager.access();
+        vector<uint64_t> available = shard->availableTablesMask();
+        vector<vector<string>> booked(available.size() * 64);
+        for (const auto& res : shard->getDaySheet(date)) {
+            if (res.tableNumber >= 0 && res.tableNumber < static_cast<int>(booked.size())) {
+                booked[res.tableNumber].push_back(res.time);
+            }
+        }
+        ostringstream json;
+        json << "{\"venue\":\"" << jsonEscape(shard->getVenueId()) << "\",\"date\":\"" << date << "\",\"tables\":[";
+        for (int table = 0; table < 10; ++table) {
+            json << (table ? "," : "") << "{\"table\":" << table + 1 << ",\"available\":"
+                 << ((available[table / 64] >> (table % 64)) & 1 ? "true" : "false") << ",\"booked\":[";
+            for (size_t i = 0; i < booked[table].size(); ++i) {
+                json << (i ? "," : "") << "\"" << booked[table][i] << "\"";
+            }
+            json << "]}";
+        }
+        json << "]}";
+        return HttpResponse::json(200, json.str());
+    }
+
+public:
+    // Validation and booking errors become 4xx responses; nothing escapes to the server loop.
+    static HttpResponse handle(const HttpRequest& request) {
+        TraceRequest trace("HTTP", request.method + " " + request.path);
+        try {
+            VenueRegistry& registry = VenueRegistry::getInstance();
+            if (request.path == "/venues") {
+                if (request.method != "GET") {
+                    return HttpResponse::error(405, "Use GET.");
+                }
+                string json = "[";
+                for (const auto& id : registry.venueIds()) {
+                    json += (json.size() > 1 ? ",\"" : "\"") + jsonEscape(id) + "\"";
+                }
+                return HttpResponse::json(200, json + "]");
+            }
+
+            auto venueParam = request.query.find("venue");
+            string venueId = venueParam == request.query.end() ? registry.defaultVenue() : venueParam->second;
+            ReservationManager* manager;
+            try {
+                manager = &registry.venue(venueId);
+            } catch (const ReservationException& ex) {
+                return HttpResponse::error(404, ex.what());
+            }
+
+            if (request.path == "/availability") {
+                return request.method == "GET" ? availability(*manager, request) : HttpResponse::error(405, "Use GET.");
+            }
+            if (request.path == "/reservations") {
+                if (request.method == "GET") {
+                    return listReservations(*manager, request);
+                }
+                return request.method == "POST" ? reserve(*manager, request) : HttpResponse::error(405, "Use GET or POST.");
+            }
+            const string prefix = "/reservations/";
+            if (request.path.compare(0, prefix.size(), prefix) == 0 && request.path.size() > prefix.size()) {
+                string id = percentDecode(request.path.substr(prefix.size()), false);
+                const string checkInSuffix = "/check-in";
+                if (id.size() > checkInSuffix.size()
+                    && id.compare(id.size() - checkInSuffix.size(), checkInSuffix.size(), checkInSuffix) == 0) {
+                    id.resize(id.size() - checkInSuffix.size());
+                    return request.method == "POST" ? checkIn(*manager, id) : HttpResponse::error(405, "Use POST.");
+                }
+                if (request.method == "GET") {
+                    auto shard = manager->access();
+                    if (!shard->reservationIdExists(id)) {
+                        return HttpResponse::error(404, "Reservation ID not found.");
+                    }
+                    return HttpResponse::json(200, reservationJson(shard->getReservation(id)));
+                }
+                if (request.method == "PATCH") {
+                    return update(*manager, id, request);
+                }
+                if (request.method == "DELETE") {
+                    return cancel(*manager, id);
+                }
+                return HttpResponse::error(405, "Use GET, PATCH or DELETE.");
+            }
+            return HttpResponse::error(404, "No such endpoint.");
+        } catch (const TableUnavailableException& ex) {
+            return HttpResponse::json(409, "{\"error\":\"" + jsonEscape(ex.what()) + "\",\"suggestion\":\""
+                                               + jsonEscape(ex.getSuggestion()) + "\"}");
+        } catch (const ReservationException& ex) {
+            return HttpResponse::error(400, ex.what());
+        } catch (const exception& ex) {
+            return HttpResponse::error(500, ex.what());
+        }
+    }
+};
+
+// Admission control in front of the shards. Each operation class has a bounded number of
+// outstanding requests (running or waiting on a shard lock); past that, requests are
+// turned away at once with a Retry-After estimate instead of piling up behind the file
+// rewrites. Each client also gets a token bucket so one caller cannot take the whole queue.
+class AdmissionController {
+public:
+    enum OpClass { READ, WRITE, OP_CLASSES };
+
+    struct Limits {
+        size_t queueCapacity[OP_CLASSES] = {256, 32};
+        double clientRate = 20.0;   // requests per second per client; 0 turns the buckets off
+        double clientBurst = 40.0;
+    };
+
+    struct Verdict {
+        bool admitted = true;
+        bool rateLimited = false;
+        int retryAfterSeconds = 0;
+    };
+
+private:
+    static const size_t BUCKET_STRIPES = 16;
+    static const size_t MAX_BUCKETS_PER_STRIPE = 4096;
+
+    struct Bucket {
+        double tokens;
+        chrono::steady_clock::time_point refilled;
+    };
+
+    struct Stripe {
+        mutex lock;
+        unordered_map<string, Bucket> buckets;
+    };
+
+    struct ClassState {
+        atomic<size_t> outstanding{0};
+        atomic<size_t> peakOutstanding{0};
+        atomic<uint64_t> admitted{0};
+        atomic<uint64_t> rejected{0};
+        atomic<uint64_t> serviceMicros{0};
+        atomic<uint64_t> completed{0};
+    };
+
+    Limits limits;
+    array<Stripe, BUCKET_STRIPES> stripes;
+    array<ClassState, OP_CLASSES> classes;
+    atomic<uint64_t> rateLimited{0};
+
+    // Seconds until the client has a whole token again, or 0 when one was taken.
+    int takeToken(const string& client) {
+        if (limits.clientRate <= 0) {
+            return 0;
+        }
+        Stripe& stripe = stripes[hash<string>()(client) % BUCKET_STRIPES];
+        auto now = chrono::steady_clock::now();
+        lock_guard<mutex> lock(stripe.lock);
+        if (stripe.buckets.size() >= MAX_BUCKETS_PER_STRIPE && !stripe.buckets.count(client)) {
+            // Idle clients have refilled to the burst size anyway; forgetting them is free.
+            for (auto it = stripe.buckets.begin(); it != stripe.buckets.end();) {
+                double seconds = chrono::duration<double>(now - it->second.refilled).count();
+                it = it->second.tokens + seconds * limits.clientRate >= limits.clientBurst ? stripe.buckets.erase(it) : next(it);
+            }
+        }
+        auto inserted = stripe.buckets.try_emplace(client, Bucket{limits.clientBurst, now});
+        Bucket& bucket = inserted.first->second;
+        double seconds = chrono::duration<double>(now - bucket.refilled).count();
+        bucket.tokens = min(limits.clientBurst, bucket.tokens + seconds * limits.clientRate);
+        bucket.refilled = now;
+        if (bucket.tokens < 1.0) {
+            return max(1, static_cast<int>(ceil((1.0 - bucket.tokens) / limits.clientRate)));
+        }
+        bucket.tokens -= 1.0;
+        return 0;
+    }
+
+public:
+    AdmissionController() = default;
+    explicit AdmissionController(const Limits& limits) : limits(limits) {}
+
+    static OpClass classify(const string& method) {
+        return method == "GET" || method == "HEAD" ? READ : WRITE;
+    }
+
+    // An admitted request must be followed by exactly one release() for its class.
+    Verdict admit(OpClass op, const string& client) {
+        Verdict verdict;
+        ClassState& state = classes[op];
+        if ((verdict.retryAfterSeconds = takeToken(client)) > 0) {
+            verdict.admitted = false;
+            verdict.rateLimited = true;
+            rateLimited++;
+            return verdict;
+        }
+        size_t outstanding = state.outstanding.fetch_add(1) + 1;
+        if (outstanding > limits.queueCapacity[op]) {
+            state.outstanding--;
+            state.rejected++;
+            uint64_t completed = state.completed;
+            double averageMicros = completed ? static_cast<double>(state.serviceMicros) / completed : 1000.0;
+            verdict.admitted = false;
+            verdict.retryAfterSeconds = max(1, static_cast<int>(ceil(outstanding * averageMicros / 1e6)));
+            return verdict;
+        }
+        size_t peak = state.peakOutstanding;
+        while (outstanding > peak && !state.peakOutstanding.compare_exchange_weak(peak, outstanding)) {
+        }
+        state.admitted++;
+        return verdict;
+    }
+
+    void release(OpClass op, uint64_t serviceMicros) {
+        ClassState& state = classes[op];
+        state.serviceMicros += serviceMicros;
+        state.completed++;
+        state.outstanding--;
+    }
+
+    void writeMetrics(ostream& out) const {
+        const char* names[OP_CLASSES] = {"read", "write"};
+        for (int op = 0; op < OP_CLASSES; ++op) {
+            const ClassState& state = classes[op];
+            out << names[op] << "_capacity " << limits.queueCapacity[op] << "\n";
+            out << names[op] << "_outstanding " << state.outstanding << "\n";
+            out << names[op] << "_peak_outstanding " << state.peakOutstanding << "\n";
+            out << names[op] << "_admitted " << state.admitted << "\n";
+            out << names[op] << "_rejected " << state.rejected << "\n";
+        }
+        out << "client_rate " << limits.clientRate << "\n";
+        out << "rate_limited " << rateLimited << "\n";
+    }
+};
+
+// A fixed pool of worker threads, each running its own epoll loop over the connections it
+// accepted. A connection stays on one worker, so pipelined requests on it are answered
+// in order; keep-alive is the HTTP/1.1 default.
+class HttpServer {
+private:
+    static const size_t MAX_HEADER_BYTES = 16 * 1024;
+    static const size_t MAX_BODY_BYTES = 64 * 1024;
+
+    struct Pending {
+        HttpRequest request;
+        int parsed = 1; // see parseRequest()
+        AdmissionController::OpClass op = AdmissionController::READ;
+        AdmissionController::Verdict verdict;
+    };
+
+    struct Connection {
+        string peer;
+        string inbound;
+        vector<Pending> pending;
+        string outbound;
+        bool peerClosed = false;
+        bool closeAfterWrite = false;
+    };
+
+    AdmissionController admission;
+    int listenFd = -1;
+    int stopFd = -1;
+    vector<thread> workers;
+    atomic<uint64_t> requestsServed{0};
+    atomic<uint64_t> connectionsAccepted{0};
+    atomic<int> connectionsOpen{0};
+    atomic<uint64_t> handleMicros{0};
+    array<atomic<uint64_t>, 6> statusClasses{}; // by status / 100
+
+    static void setNonBlocking(int fd) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    }
+
+    // Parses the next complete request off the front of the buffer. Returns 0 when more
+    // bytes are needed, a status code for a malformed request, or 1 on success.
+    static int parseRequest(string& buffer, HttpRequest& request) {
+        size_t headerEnd = buffer.find("\r\n\r\n");
+        if (headerEnd == string::npos) {
+            return buffer.size() > MAX_HEADER_BYTES ? 431 : 0;
+        }
+        istringstream head(buffer.substr(0, headerEnd));
+        string requestLine, target, version;
+        getline(head, requestLine);
+        istringstream parts(requestLine);
+        if (!(parts >> request.method >> target >> version) || version.compare(0, 5, "HTTP/") != 0) {
+            return 400;
+        }
+        string header;
+        while (getline(head, header)) {
+            if (!header.empty() && header.back() == '\r') {
+                header.pop_back();
+            }
+            size_t colon = header.find(':');
+            if (colon == string::npos) {
+                continue;
+            }
+            string name = header.substr(0, colon);
+            transform(name.begin(), name.end(), name.begin(), ::tolower);
+            size_t valueStart = header.find_first_not_of(' ', colon + 1);
+            request.headers[name] = valueStart == string::npos ? "" : header.substr(valueStart);
+        }
+        if (request.headers.count("transfer-encoding")) {
+            return 411;
+        }
+        size_t bodyLength = 0;
+        if (request.headers.count("content-length")) {
+            try {
+                bodyLength = stoul(request.headers["content-length"]);
+            } catch (...) {
+                return 400;
+            }
+        }
+        if (bodyLength > MAX_BODY_BYTES) {
+            return 413;
+        }
+        if (buffer.size() < headerEnd + 4 + bodyLength) {
+            return 0;
+        }
+        request.body = buffer.substr(headerEnd + 4, bodyLength);
+        buffer.erase(0, headerEnd + 4 + bodyLength);
+
+        string connection = request.headers["connection"];
+        transform(connection.begin(), connection.end(), connection.begin(), ::tolower);
+        request.keepAlive = version == "HTTP/1.0" ? connection == "keep-alive" : connection != "close";
+
+        size_t question = target.find('?');
+        request.path = target.substr(0, question);
+        if (question != string::npos) {
+            stringstream query(target.substr(question + 1));
+            string pair;
+            while (getline(query, pair, '&')) {
+                size_t equals = pair.find('=');
+                request.query[percentDecode(pair.substr(0, equals), true)] =
+                    equals == string::npos ? "" : percentDecode(pair.substr(equals + 1), true);
+            }
+        }
+        return 1;
+    }
+
+    // Parses every complete request off the connection and takes its admission decision
+    // there and then, so requests read but not yet answered count against their queue.
+    void receive(Connection& connection) {
+        while (!connection.closeAfterWrite) {
+            Pending pending;
+            pending.parsed = parseRequest(connection.inbound, pending.request);
+            if (pending.parsed == 0) {
+                return;
+            }
+            if (pending.parsed == 1) {
+                HttpRequest& request = pending.request;
+                auto client = request.headers.find("x-client-id");
+                request.client = client == request.headers.end() ? connection.peer : client->second;
+                pending.op = AdmissionController::classify(request.method);
+                pending.verdict = admission.admit(pending.op, request.client);
+            } else {
+                pending.request.keepAlive = false;
+            }
+            connection.closeAfterWrite = !pending.request.keepAlive;
+            connection.pending.push_back(std::move(pending));
+        }
+    }
+
+    void respond(Connection& connection) {
+        for (Pending& pending : connection.pending) {
+            HttpResponse response;
+            if (pending.parsed != 1) {
+                response = HttpResponse::error(pending.parsed, "Malformed request.");
+            } else if (pending.verdict.admitted) {
+                auto start = chrono::steady_clock::now();
+                response = HttpApi::handle(pending.request);
+                uint64_t micros = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+                admission.release(pending.op, micros);
+                handleMicros += micros;
+            } else {
+                response = pending.verdict.rateLimited ? HttpResponse::error(429, "Too many requests from this client.")
+                                                       : HttpResponse::error(503, "Booking is busy; try again shortly.");
+                response.retryAfterSeconds = pending.verdict.retryAfterSeconds;
+            }
+            requestsServed++;
+            statusClasses[min(response.status / 100, 5)]++;
+            connection.outbound += response.serialize(pending.request.keepAlive);
+        }
+        connection.pending.clear();
+    }
+
+    // Returns false when the connection should be closed.
+    static bool flush(int fd, Connection& connection) {
+        while (!connection.outbound.empty()) {
+            ssize_t written = send(fd, connection.outbound.data(), connection.outbound.size(), MSG_NOSIGNAL);
+            if (written < 0) {
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+            connection.outbound.erase(0, written);
+        }
+        return !connection.closeAfterWrite;
+    }
+
+    void run() {
+        int epollFd = epoll_create1(0);
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLEXCLUSIVE;
+        event.data.fd = listenFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+        event.events = EPOLLIN;
+        event.data.fd = stopFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, stopFd, &event);
+
+        unordered_map<int, Connection> connections;
+        auto close = [&](int fd) {
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+            ::close(fd);
+            connections.erase(fd);
+            connectionsOpen--;
+        };
+
+        // Each wakeup reads and admits everything that arrived before answering any of it.
+        epoll_event events[64];
+        vector<int> touched;
+        bool stopping = false;
+        while (!stopping) {
+            int ready = epoll_wait(epollFd, events, 64, -1);
+            touched.clear();
+            for (int i = 0; i < ready; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == stopFd) {
+                    stopping = true;
+                } else if (fd == listenFd) {
+                    int client;
+                    sockaddr_in peer{};
+                    socklen_t peerLength = sizeof(peer);
+                    while ((client = accept(listenFd, reinterpret_cast<sockaddr*>(&peer), &peerLength)) >= 0) {
+                        setNonBlocking(client);
+                        int noDelay = 1;
+                        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+                        epoll_event clientEvent{};
+                        clientEvent.events = EPOLLIN;
+                        clientEvent.data.fd = client;
+                        epoll_ctl(epollFd, EPOLL_CTL_ADD, client, &clientEvent);
+                        char peerAddress[INET_ADDRSTRLEN] = "";
+                        inet_ntop(AF_INET, &peer.sin_addr, peerAddress, sizeof(peerAddress));
+                        connections[client].peer = peerAddress;
+                        peerLength = sizeof(peer);
+                        connectionsAccepted++;
+                        connectionsOpen++;
+                    }
+                } else if (connections.count(fd)) {
+                    Connection& connection = connections[fd];
+                    if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                        char buffer[16384];
+                        ssize_t received;
+                        while ((received = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+                            connection.inbound.append(buffer, received);
+                        }
+                        connection.peerClosed = !(received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+                        receive(connection);
+                    }
+                    touched.push_back(fd);
+                }
+            }
+            for (int fd : touched) {
+                Connection& connection = connections[fd];
+                respond(connection);
+                bool open = !connection.peerClosed;
+                if (!connection.outbound.empty() || !open) {
+                    open = flush(fd, connection) && open;
+                }
+                if (!open && connection.outbound.empty()) {
+                    close(fd);
+                    continue;
+                }
+                epoll_event update{};
+                update.events = EPOLLIN | (connection.outbound.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT));
+                update.data.fd = fd;
+                epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &update);
+            }
+        }
+        for (auto& connection : connections) {
+            ::close(connection.first);
+        }
+        ::close(epollFd);
+    }
+
+public:
+    explicit HttpServer(const AdmissionController::Limits& limits = AdmissionController::Limits())
+        : admission(limits) {}
+
+    ~HttpServer() {
+        stop();
+    }
+
+    // Port 0 picks a free port; see getPort().
+    bool start(int port, int workerCount) {
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+            || ::listen(listenFd, SOMAXCONN) < 0) {
+            cerr << "Error: Unable to listen for HTTP on port " << port << ".\n";
+            return false;
+        }
+        setNonBlocking(listenFd);
+        stopFd = eventfd(0, EFD_NONBLOCK);
+        VenueRegistry::getInstance(); // load the book before the first request
+        for (int i = 0; i < workerCount; ++i) {
+            workers.emplace_back([this] { run(); });
+        }
+        Instrumentation::registerSection("http", [this](ostream& out) { writeMetrics(out); });
+        Instrumentation::registerSection("admission", [this](ostream& out) { admission.writeMetrics(out); });
+        return true;
+    }
+
+    int getPort() const {
+        sockaddr_in address{};
+        socklen_t length = sizeof(address);
+        getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), &length);
+        return ntohs(address.sin_port);
+    }
+
+    void stop() {
+        if (workers.empty()) {
+            return;
+        }
+        Instrumentation::unregisterSection("admission");
+        Instrumentation::unregisterSection("http");
+        uint64_t wake = workers.size();
+        ::write(stopFd, &wake, sizeof(wake));
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+        ::close(stopFd);
+        ::close(listenFd);
+    }
+
+    // Blocks for the life of the server (headless --http).
+    void wait() {
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+    }
+
+    void writeMetrics(ostream& out) const {
+        uint64_t served = requestsServed;
+        out << "workers " << workers.size() << "\n";
+        out << "connections_accepted " << connectionsAccepted << "\n";
+        out << "connections_open " << connectionsOpen << "\n";
+        out << "requests " << served << "\n";
+        for (int statusClass = 2; statusClass <= 5; ++statusClass) {
+            out << "responses_" << statusClass << "xx " << statusClasses[statusClass] << "\n";
+        }
+        out << "avg_handle_us " << (served ? handleMicros / served : 0) << "\n";
+    }
+};
+
+// -------- Log History Parser --------
+// Turns logs.txt back into a typed event stream. The file is mapped rather than read, and
+// parsed a batch at a time: each batch is cut at entry boundaries (entries are separated
+// by a blank line) into one piece per core, the pieces are parsed in parallel, and their
+// events are handed on in file order. Memory stays at one batch of events however large
+// the history is. Event fields are views into the mapping, valid until the sink returns.
+struct LogEvent {
+    enum Kind : uint8_t { LOGIN, RESERVE, UPDATE, CANCEL, ERROR, NOTE };
+
+    Kind kind = NOTE;
+    uint64_t offset = 0; // of the entry in the file
+    string_view role, user, action;
+    string_view details;   // "Details:" or, for errors, "Error:"
+    string_view timestamp; // logins only
+    string_view previousId; // updates and cancels: the reservation the entry acted on
+    bool hasReservation = false; // the entry carries an "ID: ... | Table: ..." line
+    string_view id, name, phone, date, time;
+    int partySize = 0;
+    int tableIndex = -1; // 0-based, as stored in reservations.txt
+};
+
+class LogEventStream {
+public:
+    struct Stats {
+        uint64_t bytes = 0;
+        uint64_t events = 0;
+        uint64_t malformed = 0;
+        double seconds = 0;
+    };
+
+private:
+    int fd = -1;
+    const char* data = nullptr;
+    size_t size = 0;
+
+    // Start of the first entry at or after pos.
+    size_t entryBoundary(size_t pos) const {
+        if (pos == 0 || pos >= size) {
+            return min(pos, size);
+        }
+        size_t found = string_view(data, size).find("\n\n", pos - 2);
+        return found == string_view::npos ? size : found + 2;
+    }
+
+    static string_view field(string_view value) {
+        return value == "N/A" ? string_view() : value;
+    }
+
+    static bool afterPrefix(string_view line, string_view prefix, string_view& rest) {
+        if (line.substr(0, prefix.size()) != prefix) {
+            return false;
+        }
+        rest = line.substr(prefix.size());
+        return true;
+    }
+
+    static int toInt(string_view value, int fallback) {
+        int parsed;
+        auto result = from_chars(value.data(), value.data() + value.size(), parsed);
+        return result.ec == errc() && result.ptr == value.data() + value.size() ? parsed : fallback;
+    }
+
+    // "ID: x | Name: x | Contact: x | Party-Size: n | Date: d | Time: t | Table: n"
+    static bool parseReservationLine(string_view line, LogEvent& event) {
+        static const string_view keys[] = {"ID: ", "Name: ", "Contact: ", "Party-Size: ", "Date: ", "Time: ", "Table: "};
+        string_view values[7];
+        for (int i = 0; i < 7; ++i) {
+            if (!afterPrefix(line, keys[i], line)) {
+                return false;
+            }
+            size_t end = i < 6 ? line.find(" | ") : line.size();
+            if (end == string_view::npos) {
+                return false;
+            }
+            values[i] = line.substr(0, end);
+            line = line.substr(min(line.size(), end + 3));
+        }
+        event.hasReservation = true;
+        event.id = field(values[0]);
+        event.name = field(values[1]);
+        event.phone = field(values[2]);
+        event.partySize = toInt(values[3], 0);
+        event.date = field(values[4]);
+        event.time = field(values[5]);
+        event.tableIndex = toInt(values[6], 0) - 1;
+        return true;
+    }
+
+    static bool parseEntry(string_view entry, LogEvent& event) {
+        size_t lineEnd = entry.find('\n');
+        string_view first = entry.substr(0, lineEnd);
+        string_view rest = lineEnd == string_view::npos ? string_view() : entry.substr(lineEnd + 1);
+        auto nextLine = [&rest]() {
+            size_t end = rest.find('\n');
+            string_view line = rest.substr(0, end);
+            rest = end == string_view::npos ? string_view() : rest.substr(end + 1);
+            return line;
+        };
+
+        string_view tail;
+        if (afterPrefix(first, "Account Log: (", tail)) {
+            // Account Log: (<timestamp>, N/A) | User: <user> | Password: <password>
+            size_t comma = tail.find(", ");
+            size_t user = tail.find(" | User: ");
+            size_t password = tail.find(" | Password: ");
+            if (comma == string_view::npos || user == string_view::npos || password == string_view::npos || user > password) {
+                return false;
+            }
+            event.kind = LogEvent::LOGIN;
+            event.timestamp = tail.substr(0, comma);
+            event.user = tail.substr(user + 9, password - user - 9);
+            return true;
+        }
+
+        bool isError = first == "Reservation Error Log";
+        if (!isError && first != "Reservation Log") {
+            return false;
+        }
+        // Action: <action> by <role>: <user>
+        string_view action;
+        if (!afterPrefix(nextLine(), "Action: ", action)) {
+            return false;
+        }
+        size_t by = action.find(" by ");
+        size_t colon = by == string_view::npos ? by : action.find(": ", by);
+        if (colon == string_view::npos) {
+            return false;
+        }
+        event.action = action.substr(0, by);
+        event.role = action.substr(by + 4, colon - by - 4);
+        event.user = action.substr(colon + 2);
+        if (!afterPrefix(nextLine(), isError ? "Error: " : "Details: ", event.details)) {
+            return false;
+        }
+        if (!rest.empty() && !parseReservationLine(nextLine(), event)) {
+            return false;
+        }
+
+        if (isError) {
+            event.kind = LogEvent::ERROR;
+        } else if (event.action == "Reserved table" && event.hasReservation) {
+            event.kind = LogEvent::RESERVE;
+        } else if ((event.action == "Updated reservation" || event.action == "Cancelled reservation") && event.hasReservation) {
+            event.kind = event.action[0] == 'U' ? LogEvent::UPDATE : LogEvent::CANCEL;
+            event.previousId = event.details.substr(0, 3) == "ID " ? event.details.substr(3) : event.id;
+        } else {
+            event.kind = LogEvent::NOTE; // account changes, maintenance, admin follow-ups
+        }
+        return true;
+    }
+
+    static void parsePiece(const char* base, size_t begin, size_t end, vector<LogEvent>& events, uint64_t& malformed) {
+        string_view text(base + begin, end - begin);
+        size_t pos = 0;
+        while (pos < text.size()) {
+            while (pos < text.size() && text[pos] == '\n') {
+                ++pos;
+            }
+            if (pos >= text.size()) {
+                break;
+            }
+            size_t stop = text.find("\n\n", pos);
+            if (stop == string_view::npos) {
+                stop = text.size();
+            }
+            LogEvent event;
+            event.offset = begin + pos;
+            string_view entry = text.substr(pos, stop - pos);
+            if (!entry.empty() && entry.back() == '\n') {
+                entry.remove_suffix(1);
+            }
+            if (parseEntry(entry, event)) {
+                events.push_back(event);
+            } else {
+                malformed++;
+            }
+            pos = stop;
+        }
+    }
 
-                    while (true) {
-                        cout << "Enter your phone number (e.g., 123-456-7890): ";
-                        getline(cin, phoneNumber);
-                        if (validatePhoneNumber(phoneNumber)) {
-                            break;
-                        }
-                        cout << "Error: Invalid phone number format. Use XXX-XXX-XXXX.\n";
-                        ReservationManager::getInstance().logError("Customer", username, "Failed to reserve table",
-                                                                  "Invalid phone number format.", "", username, phoneNumber);
-                    }
+public:
+    explicit LogEventStream(const string& path) {
+        fd = ::open(path.c_str(), O_RDONLY);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) != 0) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            throw ReservationException("Unable to open " + path + ".");
+        }
+        size = info.st_size;
+        if (size > 0) {
+            void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                throw ReservationException("Unable to map " + path + ".");
+            }
+            madvise(mapped, size, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(mapped);
+        }
+    }
 
-                    while (true) {
-                        cout << "Enter party size (must be at least 1): ";
-                        getline(cin, partySizeInput);
-                        if (!validateNumericInput(partySizeInput, partySize, 1, INT_MAX)) {
-                            cout << "Error: Invalid party size. Must be a single number >= 1 (e.g., 2, not 2a, 2.1, or 2 2).\n";
-                            ReservationManager::getInstance().logError("Customer", username, "Failed to reserve table",
-                                                                      "Invalid party size.", "", username, phoneNumber);
-                            continue;
-                        }
-                        if (!validatePartySize(partySize)) {
-                            cout << "Error: Party size must be at least 1.\n";
-                            ReservationManager::getInstance().logError("Customer", username, "Failed to reserve table",
-                                                                      "Party size must be at least 1.", "", username, phoneNumber, partySize);
-                            continue;
-                        }
+    ~LogEventStream() {
+        if (data) {
+            munmap(const_cast<char*>(data), size);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    // The n of "ID <n>A"; a cheap stand-in for validateReservationId on the hot path.
+    static bool reservationNumber(string_view id, int& number) {
+        if (id.size() < 5 || id.substr(0, 3) != "ID " || id.back() != 'A') {
+            return false;
+        }
+        auto result = from_chars(id.data() + 3, id.data() + id.size() - 1, number);
+        return result.ec == errc() && result.ptr == id.data() + id.size() - 1;
+    }
+
+    LogEventStream(const LogEventStream&) = delete;
+    LogEventStream& operator=(const LogEventStream&) = delete;
+
+    Stats forEachBatch(const function<void(const vector<LogEvent>&)>& sink, size_t batchBytes = 64 << 20) const {
+        Stats stats;
+        auto start = chrono::steady_clock::now();
+        size_t pieces = max(1u, thread::hardware_concurrency());
+        for (size_t batchStart = 0; batchStart < size;) {
+            size_t batchEnd = entryBoundary(min(size, batchStart + batchBytes));
+            vector<size_t> cuts{batchStart};
+            for (size_t i = 1; i < pieces; ++i) {
+                cuts.push_back(max(cuts.back(), entryBoundary(batchStart + (batchEnd - batchStart) * i / pieces)));
+            }
+            cuts.push_back(batchEnd);
+
+            vector<vector<LogEvent>> parsed(pieces);
+            vector<uint64_t> malformed(pieces, 0);
+            vector<future<void>> workers;
+            for (size_t i = 0; i < pieces; ++i) {
+                if (cuts[i] < cuts[i + 1]) {
+                    workers.push_back(async(launch::async, [&, i] {
+                        parsePiece(data, cuts[i], cuts[i + 1], parsed[i], malformed[i]);
+                    }));
+                }
+            }
+            for (auto& worker : workers) {
+                worker.get();
+            }
+            vector<LogEvent> batch;
+            for (size_t i = 0; i < pieces; ++i) {
+                stats.events += parsed[i].size();
+                stats.malformed += malformed[i];
+                if (batch.empty()) {
+                    batch = std::move(parsed[i]);
+                } else {
+                    batch.insert(batch.end(), parsed[i].begin(), parsed[i].end());
+                }
+            }
+            sink(batch);
+            batchStart = batchEnd;
+        }
+        stats.bytes = size;
+        stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return stats;
+    }
+};
+
+// Rebuilds reservations.txt and next_id.txt in outDir from a log history, applying each
+// reserve, update and cancel as a replication record would be, so entries are taken as
+// they happened and not re-validated against today's date.
+bool rebuildStoreFromLogs(const string& logPath, const string& outDir, ostream& out) {
+    try {
+        LogEventStream stream(logPath);
+        filesystem::create_directories(outDir);
+        if (filesystem::exists(outDir + "/reservations.txt")) {
+            throw ReservationException(outDir + "/reservations.txt already exists; rebuild into an empty directory.");
+        }
+        if (chdir(outDir.c_str()) != 0) {
+            throw ReservationException("Unable to enter " + outDir + ".");
+        }
+        VenueRegistry& registry = VenueRegistry::getInstance();
+        unique_ptr<ReservationManager> shard = registry.makeReplicaShard(registry.defaultVenue());
+        int nextId = 1;
+        uint64_t applied = 0, skipped = 0;
+        LogEventStream::Stats stats = stream.forEachBatch([&](const vector<LogEvent>& batch) {
+            for (const auto& event : batch) {
+                if (event.kind != LogEvent::RESERVE && event.kind != LogEvent::UPDATE && event.kind != LogEvent::CANCEL) {
+                    continue;
+                }
+                int number = 0;
+                if (!LogEventStream::reservationNumber(event.id, number)) {
+                    skipped++;
+                    continue;
+                }
+                MutationRecord record;
+                record.venue = registry.defaultVenue();
+                record.op = event.kind == LogEvent::RESERVE ? MutationRecord::RESERVE
+                    : event.kind == LogEvent::UPDATE ? MutationRecord::UPDATE : MutationRecord::CANCEL;
+                record.oldId = toUpperCase(string(event.previousId));
+                record.reservation = Reservation(string(event.id), string(event.name), string(event.phone),
+                                                 event.partySize, string(event.date), string(event.time), event.tableIndex);
+                nextId = max(nextId, number + 1);
+                record.nextReservationId = nextId;
+                shard->applyMutation(record);
+                applied++;
+            }
+        });
+        shard->promote();
+        out << "Rebuilt " << shard->reservationCount() << " reservations from " << applied << " changes ("
+            << stats.events << " log entries, " << skipped + stats.malformed << " skipped) in " << fixed
+            << setprecision(2) << stats.seconds << "s, " << setprecision(0) << stats.bytes / 1048576.0 / max(stats.seconds, 1e-9)
+            << " MiB/s\n" << defaultfloat;
+        return true;
+    } catch (const ReservationException& ex) {
+        cerr << "Error: " << ex.what() << "\n";
+        return false;
+    }
+}
+
+// -------- Scratch Directories --------
+// Benchmarks, the simulator and replay work on a throwaway store. This makes a fresh
+// directory under /tmp and moves into it; on the way out, however the run ends, it lets
+// queued maintenance finish writing, moves back and deletes the directory.
+class ScratchDirectory {
+private:
+    filesystem::path previous;
+    filesystem::path dir;
+
+public:
+    explicit ScratchDirectory(const string& prefix) {
+        string pattern = "/tmp/" + prefix + "-XXXXXX";
+        vector<char> name(pattern.begin(), pattern.end());
+        name.push_back('\0');
+        error_code ec;
+        previous = filesystem::current_path(ec);
+        if (ec || !mkdtemp(name.data())) {
+            return;
+        }
+        if (chdir(name.data()) != 0) {
+            filesystem::remove_all(name.data(), ec);
+            return;
+        }
+        dir = name.data();
+    }
+
+    ScratchDirectory(const ScratchDirectory&) = delete;
+    ScratchDirectory& operator=(const ScratchDirectory&) = delete;
+
+    ~ScratchDirectory() {
+        if (dir.empty()) {
+            return;
+        }
+        VenueRegistry::getInstance().waitForMaintenance();
+        error_code ec;
+        filesystem::current_path(previous, ec);
+        filesystem::remove_all(dir, ec);
+    }
+
+    // False if the directory could not be made or entered; the caller stays where it was.
+    bool entered() const {
+        return !dir.empty();
+    }
+};
+
+// -------- Benchmarks --------
+// Run with: ./Finals-Interprog --bench <name>  (availability, scan, claims, pool, http, logs)
+const int BENCH_TABLES = 80;
+
+template <class Core, class Reserve, class IsFree>
+void benchmarkAvailabilityCore(const string& label, Core& core, Reserve reserve, IsFree isFree) {
+    const int operations = 5000000;
+    const int lastStart = core.getSlotCount() - RESERVATION_SLOTS;
+    mt19937 rng(42);
+    vector<pair<int, int>> requests(4096);
+    for (auto& request : requests) {
+        request = {static_cast<int>(rng() % core.getTableCount()), static_cast<int>(rng() % (lastStart + 1))};
+    }
+
+    auto start = chrono::steady_clock::now();
+    long booked = 0;
+    for (int i = 0; i < operations; ++i) {
+        const auto& request = requests[i & 4095];
+        booked += reserve(request.first, request.second);
+        if ((i & 4095) == 4095) {
+            core.clear();
+        }
+    }
+    double reserveSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    long free = 0;
+    for (int i = 0; i < operations; ++i) {
+        const auto& request = requests[i & 4095];
+        free += isFree(request.first, request.second);
+    }
+    double checkSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << label << ": reserve " << static_cast<long>(operations / reserveSeconds) << " ops/s, check "
+         << static_cast<long>(operations / checkSeconds) << " ops/s (" << booked << " booked, " << free << " free)\n";
+}
+
+void runAvailabilityBenchmark() {
+    cout << "Availability cores, " << BENCH_TABLES << " tables x " << SLOTS_PER_DAY << " slots, "
+         << RESERVATION_SLOTS << "-slot reservations\n";
+    DynamicAvailabilityCore dynamicCore(BENCH_TABLES, SLOTS_PER_DAY);
+    benchmarkAvailabilityCore("Dynamic", dynamicCore,
+        [&](int table, int slot) { return dynamicCore.reserve(table, slot, RESERVATION_SLOTS); },
+        [&](int table, int slot) { return dynamicCore.isFree(table, slot, RESERVATION_SLOTS); });
+    FixedAvailabilityCore<BENCH_TABLES, SLOTS_PER_DAY> fixedCore;
+    benchmarkAvailabilityCore("Fixed  ", fixedCore,
+        [&](int table, int slot) { return fixedCore.reserve<RESERVATION_SLOTS>(table, slot); },
+        [&](int table, int slot) { return fixedCore.isFree<RESERVATION_SLOTS>(table, slot); });
+}
+
+// "Which tables are free for [a, b)" and "first slot >= t with a free table seating p",
+// each done three ways: table-by-table bit checks, the word-at-a-time scalar kernel, and
+// the compiled SIMD kernel.
+void runScanBenchmark() {
+    const int queries = 2000000;
+    mt19937 rng(7);
+    vector<int> capacities(BENCH_TABLES);
+    for (int table = 0; table < BENCH_TABLES; ++table) {
+        capacities[table] = 2 + 2 * (table % 4);
+    }
+    DynamicAvailabilityCore core(BENCH_TABLES, SLOTS_PER_DAY);
+    for (int i = 0; i < BENCH_TABLES * 10; ++i) {
+        core.reserve(rng() % BENCH_TABLES, rng() % (SLOTS_PER_DAY - RESERVATION_SLOTS + 1), RESERVATION_SLOTS);
+    }
+    vector<pair<int, int>> windows(4096);
+    for (auto& window : windows) {
+        window = {static_cast<int>(rng() % (SLOTS_PER_DAY - RESERVATION_SLOTS + 1)), 1 + static_cast<int>(rng() % 8)};
+    }
+    const int words = (BENCH_TABLES + 63) / 64;
+    cout << "Free-table scans, " << BENCH_TABLES << " tables x " << SLOTS_PER_DAY << " slots, kernel: "
+         << SCAN_KERNEL_NAME << "\n";
+
+    auto report = [&](const string& label, double seconds, long checksum) {
+        cout << "  " << label << static_cast<long>(queries / seconds) << " queries/s (checksum " << checksum << ")\n";
+    };
+    auto time = [](auto&& body) {
+        auto start = chrono::steady_clock::now();
+        body();
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+    auto countBooked = [words](const vector<uint64_t>& booked) {
+        int count = 0;
+        for (int w = 0; w < words; ++w) {
+            count += __builtin_popcountll(booked[w]);
+        }
+        return count;
+    };
+
+    long checksum = 0;
+    double seconds = time([&] {
+        for (int i = 0; i < queries; ++i) {
+            const auto& window = windows[i & 4095];
+            for (int table = 0; table < BENCH_TABLES; ++table) {
+                checksum += core.isFree(table, window.first, RESERVATION_SLOTS);
+            }
+        }
+    });
+    report("free tables, per-table loop: ", seconds, checksum);
+    checksum = 0;
+    seconds = time([&] {
+        vector<uint64_t> booked(words);
+        for (int i = 0; i < queries; ++i) {
+            const auto& window = windows[i & 4095];
+            orSlotRowsScalar(core.data(), words, window.first, window.first + RESERVATION_SLOTS, booked.data());
+            checksum += BENCH_TABLES - countBooked(booked);
+        }
+    });
+    report("free tables, scalar kernel:  ", seconds, checksum); // auto-vectorized when the width is known
+    checksum = 0;
+    seconds = time([&] {
+        vector<uint64_t> booked(words);
+        for (int i = 0; i < queries; ++i) {
+            const auto& window = windows[i & 4095];
+            orSlotRows(core.data(), words, window.first, window.first + RESERVATION_SLOTS, booked.data());
+            checksum += BENCH_TABLES - countBooked(booked);
+        }
+    });
+    report("free tables, SIMD kernel:    ", seconds, checksum);
+
+    vector<vector<uint64_t>> eligible;
+    for (int partySize = 1; partySize <= 8; ++partySize) {
+        eligible.push_back(tablesWithCapacity(capacities, partySize));
+    }
+    checksum = 0;
+    seconds = time([&] {
+        for (int i = 0; i < queries; ++i) {
+            const auto& window = windows[i & 4095];
+            int found = -1;
+            for (int slot = window.first; found < 0 && slot + RESERVATION_SLOTS <= SLOTS_PER_DAY; ++slot) {
+                for (int table = 0; table < BENCH_TABLES; ++table) {
+                    if (capacities[table] >= window.second && core.isFree(table, slot, RESERVATION_SLOTS)) {
+                        found = slot;
                         break;
                     }
+                }
+            }
+            checksum += found;
+        }
+    });
+    report("first free slot, scalar:     ", seconds, checksum);
+    checksum = 0;
+    seconds = time([&] {
+        for (int i = 0; i < queries; ++i) {
+            const auto& window = windows[i & 4095];
+            int table;
+            checksum += core.findFirstFreeSlot(window.first, RESERVATION_SLOTS, eligible[window.second - 1], table);
+        }
+    });
+    report("first free slot, SIMD:       ", seconds, checksum);
+}
 
-                    while (true) {
-                        cout << "Enter reservation date (e.g., YYYY-MM-DD, must be on or after " << CURRENT_DATE << "): ";
-                        getline(cin, date);
-                        if (validateDate(date)) {
-                            break;
-                        }
-                        cout << "Error: Invalid date format (use YYYY-MM-DD) or date is in the past.\n";
-                        ReservationManager::getInstance().logError("Customer", username, "Failed to reserve table",
-                                                                 "Invalid date format or date is in the past.",
-                                                                 "", username, phoneNumber, partySize, date);
-                    }
+// Stress test for AtomicSlotBitmap: every round, several threads race to claim random
+// overlapping windows on a small floor. Afterwards each winning claim is replayed into a
+// per-slot counter; any cell claimed twice, or a bit set that no winner owns, is a failure.
+// So is a lost claim whose window overlaps no winner: it was refused over a rival that
+// backed out.
+bool runClaimStressTest() {
+    const int threadCount = 8;
+    const int rounds = 500;
+    const int attemptsPerThread = 64;
+    const int stressTables = 10;
+    long totalClaims = 0, totalWins = 0, doubleBookings = 0, lostClaims = 0;
 
-                    while (true) {
-                        cout << "Enter reservation time (e.g., HH:MM in 24-hour format, must be after "
-                             << (CURRENT_HOUR < 10 ? "0" : "") << CURRENT_HOUR << ":"
-                             << (CURRENT_MINUTE < 10 ? "0" : "") << CURRENT_MINUTE << " if today): ";
-                        getline(cin, time);
-                        if (validateTime(time, date)) {
-                            break;
-                        }
-                        cout << "Error: Invalid time format (use HH:MM) or time is in the past for today.\n";
-                        ReservationManager::getInstance().logError("Customer", username, "Failed to reserve table",
-                                                                 "Invalid time format or time is in the past.",
-                                                                 "", username, phoneNumber, partySize, date, time);
+    auto start = chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        AtomicSlotBitmap board(stressTables, SLOTS_PER_DAY);
+        vector<vector<array<int, 2>>> wins(threadCount), losses(threadCount);
+        atomic<int> ready(0);
+        vector<thread> workers;
+        for (int t = 0; t < threadCount; ++t) {
+            workers.emplace_back([&, t] {
+                mt19937 rng(round * threadCount + t);
+                ready.fetch_add(1);
+                while (ready.load() < threadCount) {
+                    this_thread::yield();
+                }
+                for (int i = 0; i < attemptsPerThread; ++i) {
+                    int table = rng() % stressTables;
+                    int firstSlot = 72 + rng() % 16; // everyone wants 18:00-22:00
+                    if (board.claim(table, firstSlot, RESERVATION_SLOTS)) {
+                        wins[t].push_back({table, firstSlot});
+                    } else {
+                        losses[t].push_back({table, firstSlot});
                     }
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
 
-                    bool reservationComplete = false;
-                    while (!reservationComplete) {
-                        cout << "Available tables:\n";
-                        ReservationManager::getInstance().viewTableAvailability();
-                        cout << "Enter table number to reserve (1-10, or 0 to cancel): ";
-                        getline(cin, tableInput);
+        vector<int> owners(stressTables * SLOTS_PER_DAY, 0);
+        for (const auto& threadWins : wins) {
+            totalWins += threadWins.size();
+            for (const auto& win : threadWins) {
+                for (int slot = win[1]; slot < win[1] + RESERVATION_SLOTS; ++slot) {
+                    owners[win[0] * SLOTS_PER_DAY + slot]++;
+                }
+            }
+        }
+        DynamicAvailabilityCore claimed = board.snapshot();
+        for (int table = 0; table < stressTables; ++table) {
+            for (int slot = 0; slot < SLOTS_PER_DAY; ++slot) {
+                int count = owners[table * SLOTS_PER_DAY + slot];
+                if (count > 1 || (count == 1) == claimed.isFree(table, slot, 1)) {
+                    doubleBookings++;
+                }
+            }
+        }
+        for (const auto& threadLosses : losses) {
+            for (const auto& loss : threadLosses) {
+                bool beaten = false;
+                for (int slot = loss[1]; slot < loss[1] + RESERVATION_SLOTS; ++slot) {
+                    beaten = beaten || owners[loss[0] * SLOTS_PER_DAY + slot] > 0;
+                }
+                lostClaims += !beaten;
+            }
+        }
+        totalClaims += threadCount * attemptsPerThread;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
 
-                        if (tableInput == "0") {
-                            cout << "Reservation cancelled.\n";
-                            reservationComplete = true;
-                            break;
-                        }
+    cout << "Claim stress test: " << threadCount << " threads x " << rounds << " rounds, " << totalClaims
+         << " claims, " << totalWins << " won, " << static_cast<long>(totalClaims / seconds) << " claims/s\n";
+    cout << (doubleBookings + lostClaims == 0 ? "PASS" : "FAIL") << ": " << doubleBookings
+         << " double-booked or orphaned slots, " << lostClaims << " claims lost to no winner\n";
+    return doubleBookings + lostClaims == 0;
+}
 
-                        if (!validateNumericInput(tableInput, tableNumber, 1, 10)) {
-                            cout << "Error: Invalid table number. Must be a single number between 1 and 10 (e.g., 1, not 1a, 1.1, or 1 1).\n";
-                            ReservationManager::getInstance().logError("Customer", username, "Failed to reserve table",
-                                                                     "Invalid table number.",
-                                                                     "", username, phoneNumber, partySize, date, time);
-                            continue;
-                        }
-                        tableNumber--;
+// Foreground work must not queue behind maintenance: two workers get a backlog of 20 ms
+// maintenance tasks, then one foreground task, which has to run while nearly all of the
+// backlog is still waiting. Once the pool is idle both queue gauges must read zero.
+bool runSchedulerBenchmark() {
+    const int maintenanceTasks = 40;
+    WorkStealingPool pool(2);
+    atomic<int> maintenanceDone(0);
+    for (int i = 0; i < maintenanceTasks; ++i) {
+        pool.submit(TaskPriority::MAINTENANCE, [&maintenanceDone] {
+            this_thread::sleep_for(chrono::milliseconds(20));
+            maintenanceDone++;
+        });
+    }
+    promise<int> foreground;
+    auto submitted = chrono::steady_clock::now();
+    pool.submit(TaskPriority::FOREGROUND, [&] { foreground.set_value(maintenanceDone.load()); });
+    int doneFirst = foreground.get_future().get();
+    double waitMillis = chrono::duration<double, milli>(chrono::steady_clock::now() - submitted).count();
+    pool.waitIdle();
+    long foregroundDepth = pool.queueDepth(TaskPriority::FOREGROUND);
+    long maintenanceDepth = pool.queueDepth(TaskPriority::MAINTENANCE);
 
-                        try {
-                            int table = ReservationManager::getInstance().reserveTable(username, phoneNumber, partySize, date, time, tableNumber);
-                            cout << "Reserved Table #" << table + 1 << " successfully!\n";
-                            reservationComplete = true;
-                        } catch (const ReservationException& ex) {
-                            if (string(ex.what()) == "Selected table is already booked.") {
-                                cout << "Error: Selected table is already booked. Please choose a different table.\n";
-                                ReservationManager::getInstance().logError("Customer", username, "Failed to reserve table",
-                                                                         ex.what(), "", username, phoneNumber, partySize, date, time, tableNumber);
-                            } else {
-                                cout << "Error: " << ex.what() << endl;
-                                ReservationManager::getInstance().logError("Customer", username, "Failed to reserve table",
-                                                                         ex.what(), "", username, phoneNumber, partySize, date, time, tableNumber);
-                                cout << "Reservation failed. Returning to menu.\n";
-                                reservationComplete = true;
-                            }
-                        }
-                    }
+    cout << "Scheduler: foreground task done after " << fixed << setprecision(1) << waitMillis << "ms, with "
+         << doneFirst << " of " << maintenanceTasks << " maintenance tasks finished\n" << defaultfloat;
+    cout << "Queue depth when idle: foreground " << foregroundDepth << ", maintenance " << maintenanceDepth << "\n";
+    bool passed = doneFirst < maintenanceTasks / 4 && foregroundDepth == 0 && maintenanceDepth == 0;
+    cout << (passed ? "PASS" : "FAIL") << ": foreground work ran ahead of the maintenance backlog\n";
+    return passed;
+}
+
+// Load test for the HTTP API: keep-alive clients against a server on an ephemeral port,
+// first one request in flight per connection, then pipelined, then a write burst with and
+// without admission control. Runs in a scratch directory so the real book is never touched.
+struct HttpLoadResult {
+    long requests = 0;
+    long failures = 0;
+    long rejected = 0; // 429 and 503; these do not count toward latency
+    vector<double> latenciesMicros;
+};
+
+bool readHttpResponse(int fd, string& buffer, int& status) {
+    char chunk[16384];
+    while (true) {
+        size_t headerEnd = buffer.find("\r\n\r\n");
+        if (headerEnd != string::npos) {
+            size_t lengthAt = buffer.find("Content-Length: ");
+            size_t bodyLength = lengthAt < headerEnd ? stoul(buffer.substr(lengthAt + 16)) : 0;
+            if (buffer.size() >= headerEnd + 4 + bodyLength) {
+                status = stoi(buffer.substr(9, 3));
+                buffer.erase(0, headerEnd + 4 + bodyLength);
+                return true;
+            }
+        }
+        ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+        if (received <= 0) {
+            return false;
+        }
+        buffer.append(chunk, received);
+    }
+}
+
+HttpLoadResult runHttpLoad(int port, const vector<string>& requests, int clients, int depth, double seconds) {
+    vector<HttpLoadResult> results(clients);
+    vector<thread> threads;
+    auto deadline = chrono::steady_clock::now() + chrono::duration<double>(seconds);
+    for (int c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c] {
+            HttpLoadResult& result = results[c];
+            int fd = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = htons(port);
+            int noDelay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+                result.failures++;
+                ::close(fd);
+                return;
+            }
+            string inbound;
+            size_t next = c;
+            while (result.requests == 0 || chrono::steady_clock::now() < deadline) {
+                string batch;
+                for (int i = 0; i < depth; ++i) {
+                    batch += requests[next++ % requests.size()];
+                }
+                auto start = chrono::steady_clock::now();
+                if (send(fd, batch.data(), batch.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(batch.size())) {
+                    result.failures++;
                     break;
                 }
-                case 4: {
-                    if (!ReservationManager::getInstance().hasReservations(username)) {
-                        cout << "No reservations.\n";
-                        break;
+                bool anyRejected = false;
+                for (int i = 0; i < depth; ++i) {
+                    int status;
+                    if (!readHttpResponse(fd, inbound, status)) {
+                        result.failures += depth - i;
+                        ::close(fd);
+                        return;
                     }
+                    bool rejected = status == 429 || status == 503;
+                    anyRejected = anyRejected || rejected;
+                    result.rejected += rejected;
+                    result.failures += status >= 300 && !rejected;
+                }
+                result.requests += depth;
+                if (!anyRejected) {
+                    result.latenciesMicros.push_back(
+                        chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / depth);
+                }
+            }
+            ::close(fd);
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    HttpLoadResult total;
+    for (auto& result : results) {
+        total.requests += result.requests;
+        total.failures += result.failures;
+        total.rejected += result.rejected;
+        total.latenciesMicros.insert(total.latenciesMicros.end(), result.latenciesMicros.begin(), result.latenciesMicros.end());
+    }
+    sort(total.latenciesMicros.begin(), total.latenciesMicros.end());
+    return total;
+}
 
-                    string reservationId, newId = "0", newName, newPhone, newDate, newTime, newPartySizeInput, newTableChoiceInput;
-                    int newPartySize = 0, newTableChoice = 0, newTableIndex = -1;
+// The same race through the booking path: desks on several threads call reserveTable on
+// one venue for overlapping evening slots, then everything is cancelled for the next
+// round. No two wins may overlap on a table, every win must be a stored, claimed
+// reservation, every refusal must overlap a win, and the table flags must agree with the
+// book.
+bool runReserveStressTest() {
+    const int threadCount = 8;
+    const int rounds = 200;
+    const int attemptsPerThread = 8;
+    ScratchDirectory scratch("reserve-stress");
+    if (!scratch.entered()) {
+        cerr << "Error: Unable to create a scratch directory.\n";
+        return false;
+    }
+    ReservationManager& venue = VenueRegistry::getInstance().venue(VenueRegistry::getInstance().defaultVenue());
+    long attempts = 0, wins = 0, failures = 0;
 
-                    while (true) {
-                        cout << "Enter reservation ID to update (e.g., ID 1A): ";
-                        getline(cin, reservationId);
-                        reservationId = toUpperCase(reservationId);
-                        try {
-                            if (!validateReservationId(reservationId)) {
-                                throw ReservationException("Invalid reservation ID format. Use 'ID <number>A', e.g., ID 1A.");
-                            }
-                            bool hasReservation = false;
-                            vector<Reservation> allRes = ReservationManager::getInstance().getAllReservations();
-                            for (const auto& res : allRes) {
-                                if (res.id == reservationId && res.customerName == username) {
-                                    hasReservation = true;
-                                    break;
-                                }
-                            }
-                            if (!hasReservation) {
-                                throw ReservationException("No reservation to update.");
-                            }
-                            break;
-                        } catch (const ReservationException& ex) {
-                            cout << "Error: " << ex.what() << endl;
-                            ReservationManager::getInstance().logError("Customer", username, "Failed to update reservation",
-                                                                     ex.what(), reservationId, username);
-                        }
+    auto start = chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        vector<vector<array<int, 2>>> won(threadCount), lost(threadCount);
+        atomic<int> ready(0);
+        atomic<long> unexpected(0);
+        vector<thread> workers;
+        for (int t = 0; t < threadCount; ++t) {
+            workers.emplace_back([&, t] {
+                mt19937 rng(round * threadCount + t);
+                string phone = "555-010-" + to_string(1000 + t);
+                ready.fetch_add(1);
+                while (ready.load() < threadCount) {
+                    this_thread::yield();
+                }
+                for (int i = 0; i < attemptsPerThread; ++i) {
+                    int table = rng() % 10;
+                    int firstSlot = 72 + rng() % 16; // everyone wants 18:00-22:00
+                    try {
+                        venue.reserveTable("desk" + to_string(t), phone, 2, "2099-06-01", slotToTime(firstSlot), table);
+                        won[t].push_back({table, firstSlot});
+                    } catch (const TableUnavailableException&) {
+                        lost[t].push_back({table, firstSlot});
+                    } catch (const exception&) {
+                        unexpected++;
                     }
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        auto shard = venue.access();
+        vector<int> owners(10 * SLOTS_PER_DAY, 0);
+        long roundWins = 0;
+        for (const auto& threadWins : won) {
+            roundWins += threadWins.size();
+            for (const auto& win : threadWins) {
+                for (int slot = win[1]; slot < win[1] + RESERVATION_SLOTS; ++slot) {
+                    owners[win[0] * SLOTS_PER_DAY + slot]++;
+                }
+            }
+        }
+        wins += roundWins;
+        vector<Reservation> book = shard->getAllReservations();
+        vector<uint64_t> available = shard->availableTablesMask();
+        failures += unexpected.load();
+        failures += count_if(owners.begin(), owners.end(), [](int n) { return n > 1; });
+        for (const auto& threadLosses : lost) {
+            for (const auto& loss : threadLosses) {
+                bool beaten = false;
+                for (int slot = loss[1]; slot < loss[1] + RESERVATION_SLOTS; ++slot) {
+                    beaten = beaten || owners[loss[0] * SLOTS_PER_DAY + slot] > 0;
+                }
+                failures += !beaten;
+            }
+        }
+        for (int table = 0; table < 10; ++table) {
+            bool stored = any_of(book.begin(), book.end(), [table](const Reservation& res) { return res.tableNumber == table; });
+            bool free = (available[0] >> table) & 1;
+            if (stored == free) {
+                failures++;
+            }
+        }
+        if (book.size() != static_cast<size_t>(roundWins)) {
+            failures++;
+        }
+        for (const auto& res : book) {
+            if (!shard->isSlotClaimed(res.date, res.time, res.tableNumber)) {
+                failures++; // booked but never claimed
+            }
+            shard->cancelReservation(res.id, res.customerName);
+        }
+        attempts += threadCount * attemptsPerThread;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Reserve stress test: " << threadCount << " threads x " << rounds << " rounds, " << attempts
+         << " bookings tried, " << wins << " won, " << static_cast<long>(attempts / seconds) << " bookings/s\n";
+    cout << (failures == 0 ? "PASS" : "FAIL") << ": " << failures << " double bookings, lost claims or mismatched tables\n";
+    return failures == 0;
+}
+
+bool runHttpBenchmark() {
+    const int workerCount = 4, clients = 16;
+    const double seconds = 2.0;
+    ScratchDirectory scratch("http-bench");
+    if (!scratch.entered()) {
+        cerr << "Error: Unable to create a scratch directory.\n";
+        return false;
+    }
+
+    AdmissionController::Limits unlimited;
+    unlimited.queueCapacity[AdmissionController::READ] = unlimited.queueCapacity[AdmissionController::WRITE] = SIZE_MAX;
+    unlimited.clientRate = 0;
+    unique_ptr<HttpServer> server(new HttpServer(unlimited));
+    if (!server->start(0, workerCount)) {
+        return false;
+    }
+    int port = server->getPort();
+    LockProfiler::enable();
+
+    vector<string> seeds;
+    for (int table = 1; table <= 10; ++table) {
+        string body = "{\"name\":\"Guest " + to_string(table) + "\",\"phone\":\"555-010-" + to_string(1000 + table)
+                      + "\",\"partySize\":" + to_string(1 + table % 6) + ",\"date\":\"2099-01-0" + to_string(1 + table % 7)
+                      + "\",\"time\":\"19:00\",\"table\":" + to_string(table) + "}";
+        seeds.push_back("POST /reservations HTTP/1.1\r\nHost: bench\r\nContent-Type: application/json\r\nContent-Length: "
+                        + to_string(body.size()) + "\r\n\r\n" + body);
+    }
+    HttpLoadResult seeded = runHttpLoad(port, seeds, 1, static_cast<int>(seeds.size()), 0.0);
+    if (seeded.failures > 0 || seeded.requests != static_cast<long>(seeds.size())) {
+        cerr << "Error: Seeding the book over HTTP failed.\n";
+        return false;
+    }
+
+    vector<string> reads;
+    for (int n = 1; n <= 10; ++n) {
+        reads.push_back("GET /reservations/ID%20" + to_string(n) + "A HTTP/1.1\r\nHost: bench\r\n\r\n");
+        reads.push_back("GET /reservations?phone=555-010-" + to_string(1000 + n) + " HTTP/1.1\r\nHost: bench\r\n\r\n");
+    }
+    reads.push_back("GET /availability?date=2099-01-02 HTTP/1.1\r\nHost: bench\r\n\r\n");
+    reads.push_back("GET /reservations?date=2099-01-01&to=2099-01-07 HTTP/1.1\r\nHost: bench\r\n\r\n");
+
+    bool clean = true;
+    auto report = [&](const string& label, const HttpLoadResult& result) {
+        auto percentile = [&](double p) {
+            return result.latenciesMicros.empty() ? 0.0
+                : result.latenciesMicros[static_cast<size_t>(p * (result.latenciesMicros.size() - 1))];
+        };
+        cout << label << ": " << static_cast<long>((result.requests - result.rejected) / seconds)
+             << " req/s, p50 " << fixed << setprecision(1) << percentile(0.5) << "us, p99 " << percentile(0.99)
+             << "us per request, " << result.rejected << " rejected, " << result.failures << " failures\n"
+             << defaultfloat;
+        clean = clean && result.failures == 0;
+    };
+
+    cout << "HTTP API, " << workerCount << " workers, " << clients << " keep-alive clients, " << seconds << "s per run\n";
+    for (int depth : {1, 16}) {
+        report("pipeline depth " + string(depth < 10 ? " " : "") + to_string(depth), runHttpLoad(port, reads, clients, depth, seconds));
+    }
+
+    // Booking burst: every client rewrites the book, first with no admission limits, then
+    // with a small write queue that turns the excess away with Retry-After.
+    const int burstClients = 64;
+    vector<string> writes;
+    for (int n = 1; n <= 10; ++n) {
+        for (int size : {2, 3}) {
+            string body = "{\"partySize\":" + to_string(size) + "}";
+            writes.push_back("PATCH /reservations/ID%20" + to_string(n) + "A HTTP/1.1\r\nHost: bench\r\nContent-Length: "
+                             + to_string(body.size()) + "\r\n\r\n" + body);
+        }
+    }
+    cout << "Booking burst, " << burstClients << " clients\n";
+    report("no admission control", runHttpLoad(port, writes, burstClients, 1, seconds));
+    server.reset();
+    AdmissionController::Limits bounded = unlimited;
+    bounded.queueCapacity[AdmissionController::WRITE] = workerCount * 2;
+    server.reset(new HttpServer(bounded));
+    if (!server->start(0, workerCount)) {
+        return false;
+    }
+    report("write queue capped at " + to_string(workerCount * 2), runHttpLoad(server->getPort(), writes, burstClients, 1, seconds));
+    server.reset();
+
+    cout << "Hottest lock sites\n";
+    LockProfiler::report(cout, 3);
+    return clean;
+}
+
+// Replays the reserve, update and cancel entries of a log history through the booking
+// engine in a scratch store. Dates are moved forward by whole years so the oldest lands
+// after today, and logged IDs are mapped to the IDs the engine hands out.
+bool runLogWorkloadBenchmark(const string& logPath) {
+    vector<LogEvent> workload;
+    string arena; // the mapping is gone once the stream closes, so the fields are copied here
+    LogEventStream::Stats parse;
+    try {
+        LogEventStream stream(logPath);
+        parse = stream.forEachBatch([&](const vector<LogEvent>& batch) {
+            for (const auto& event : batch) {
+                if (event.kind == LogEvent::RESERVE || event.kind == LogEvent::UPDATE || event.kind == LogEvent::CANCEL) {
+                    workload.push_back(event);
+                }
+            }
+        });
+        size_t total = 0;
+        for (const auto& event : workload) {
+            total += event.id.size() + event.name.size() + event.phone.size() + event.date.size() + event.time.size()
+                     + event.previousId.size();
+        }
+        arena.reserve(total);
+        auto keep = [&arena](string_view& view) {
+            size_t at = arena.size();
+            arena.append(view);
+            view = string_view(arena.data() + at, view.size());
+        };
+        for (auto& event : workload) {
+            keep(event.id);
+            keep(event.name);
+            keep(event.phone);
+            keep(event.date);
+            keep(event.time);
+            keep(event.previousId);
+            event.role = event.user = event.action = event.details = event.timestamp = string_view();
+        }
+    } catch (const ReservationException& ex) {
+        cerr << "Error: " << ex.what() << "\n";
+        return false;
+    }
+    cout << "Parsed " << parse.events << " log entries (" << parse.malformed << " malformed) in " << fixed
+         << setprecision(2) << parse.seconds << "s, " << setprecision(0) << parse.bytes / 1048576.0 / max(parse.seconds, 1e-9)
+         << " MiB/s; " << workload.size() << " booking changes\n" << defaultfloat;
+
+    string today = Clock::read().date;
+    int currentYear = stoi(today.substr(0, 4));
+    int yearShift = 0;
+    for (const auto& event : workload) {
+        if (event.date.size() == 10 && string(event.date) <= today) {
+            yearShift = max(yearShift, currentYear - stoi(string(event.date.substr(0, 4))) + 1);
+        }
+    }
+    auto shiftDate = [yearShift](string_view date) {
+        if (yearShift == 0 || date.size() != 10) {
+            return string(date);
+        }
+        int year = stoi(string(date.substr(0, 4))) + yearShift;
+        bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+        string shifted = to_string(year) + string(date.substr(4));
+        return !leap && date.substr(5) == "02-29" ? to_string(year) + "-02-28" : shifted;
+    };
+
+    ScratchDirectory scratch("log-bench");
+    if (!scratch.entered()) {
+        cerr << "Error: Unable to create a scratch directory.\n";
+        return false;
+    }
+    ReservationManager& venue = VenueRegistry::getInstance().venue(VenueRegistry::getInstance().defaultVenue());
+    unordered_map<string, string> engineIds; // logged ID -> ID the engine assigned
+    long accepted[3] = {0, 0, 0}, rejected[3] = {0, 0, 0};
+    auto start = chrono::steady_clock::now();
+    for (const auto& event : workload) {
+        int kind = event.kind == LogEvent::RESERVE ? 0 : event.kind == LogEvent::UPDATE ? 1 : 2;
+        try {
+            auto shard = venue.access();
+            if (event.kind == LogEvent::RESERVE) {
+                shard->reserveTable(string(event.name), string(event.phone), event.partySize, shiftDate(event.date),
+                                    string(event.time), event.tableIndex);
+                engineIds[string(event.id)] = "ID " + to_string(shard->getNextReservationId() - 1) + "A";
+            } else {
+                auto it = engineIds.find(string(event.previousId));
+                if (it == engineIds.end()) {
+                    throw ReservationException("Reservation was never booked in this run.");
+                }
+                string engineId = it->second;
+                if (event.kind == LogEvent::UPDATE) {
+                    shard->updateReservation(engineId, string(event.name), "0", string(event.name), string(event.phone),
+                                             event.partySize, shiftDate(event.date), string(event.time), event.tableIndex);
+                    engineIds.erase(it);
+                    engineIds[string(event.id)] = engineId;
+                } else {
+                    shard->cancelReservation(engineId, string(event.name));
+                    engineIds.erase(it);
+                }
+            }
+            accepted[kind]++;
+        } catch (const ReservationException&) {
+            rejected[kind]++;
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    static const char* labels[] = {"reserve", "update", "cancel"};
+    cout << "Replayed through the engine in " << fixed << setprecision(2) << seconds << "s ("
+         << setprecision(0) << workload.size() / max(seconds, 1e-9) << " changes/s, dates moved " << yearShift
+         << " years)\n" << defaultfloat;
+    for (int kind = 0; kind < 3; ++kind) {
+        cout << "  " << left << setw(8) << labels[kind] << right << " accepted " << setw(9) << accepted[kind]
+             << "  rejected " << setw(9) << rejected[kind] << "\n";
+    }
+    return true;
+}
 
-                    while (true) {
-                        cout << "Enter new name (or 0 to keep current): ";
-                        getline(cin, newName);
-                        break;
-                    }
+bool runBenchmark(const string& name, const string& input = "") {
+    if (name == "availability") {
+        runAvailabilityBenchmark();
+    } else if (name == "scan") {
+        runScanBenchmark();
+    } else if (name == "claims") {
+        bool bitmapPassed = runClaimStressTest();
+        return runReserveStressTest() && bitmapPassed;
+    } else if (name == "pool") {
+        return runSchedulerBenchmark();
+    } else if (name == "http") {
+        return runHttpBenchmark();
+    } else if (name == "logs") {
+        return runLogWorkloadBenchmark(input.empty() ? "logs.txt" : input);
+    } else {
+        cerr << "Unknown benchmark: " << name << "\n";
+        return false;
+    }
+    return true;
+}
 
-                    while (true) {
-                        cout << "Enter new phone number (e.g., 123-456-7890, or 0 to keep current): ";
-                        getline(cin, newPhone);
-                        if (newPhone == "0") break;
-                        if (validatePhoneNumber(newPhone)) break;
-                        cout << "Error: Invalid phone number format. Use XXX-XXX-XXXX.\n";
-                        ReservationManager::getInstance().logError("Customer", username, "Failed to update reservation",
-                                                                 "Invalid phone number format.", reservationId, username, newPhone);
-                    }
+// -------- Synthetic Data Generator --------
+// Run with: ./Finals-Interprog --generate <reservations> [--seed n] [--out dir]
+// Writes customer_accounts.txt, reservations.txt, next_id.txt and logs.txt in the formats
+// the app reads, for 1k to 10M reservations. Output depends only on the count and the
+// seed: records are produced in fixed-size chunks, each with its own random stream, and
+// the chunks of a wave are generated and written (pwrite at precomputed offsets) in
+// parallel.
+//
+// Distributions: customers book with a long tail (a few regulars, many one-offs); first
+// and last names follow a Zipf-like popularity; phone numbers are stable per customer;
+// dates fall in the year after today (longer for very large books) with busy
+// Fridays and Saturdays and a December peak; times cluster around a 19:00 dinner rush
+// with a smaller lunch service; parties of two dominate. A quarter of the bookings are
+// taken by reception under the guest's full name rather than a customer account.
+// Tables are picked by party size alone, so a book denser than ten tables can seat has
+// overlapping bookings; loadReservations keeps the first of each and drops the rest.
+class SyntheticBookGenerator {
+private:
+    static const size_t CHUNK_RECORDS = 1 << 16;
 
-                    while (true) {
-                        cout << "Enter new party size (must be at least 1, or 0 to keep current): ";
-                        getline(cin, newPartySizeInput);
-                        if (newPartySizeInput == "0") {
-                            newPartySize = 0;
-                            break;
-                        }
-                        if (!validateNumericInput(newPartySizeInput, newPartySize, 1, INT_MAX)) {
-                            cout << "Error: Invalid party size. Must be a single number >= 1 (e.g., 2, not 2a, 2.1, or 2 2).\n";
-                            ReservationManager::getInstance().logError("Customer", username, "Failed to update reservation",
-                                                                     "Invalid party size.", reservationId, username, newPhone, newPartySize);
-                            continue;
-                        }
-                        if (!validatePartySize(newPartySize)) {
-                            cout << "Error: Party size must be at least 1.\n";
-                            ReservationManager::getInstance().logError("Customer", username, "Failed to update reservation",
-                                                                     "Party size must be at least 1.", reservationId, username, newPhone, newPartySize);
-                            continue;
-                        }
-                        break;
-                    }
+    size_t reservationCount;
+    size_t customerCount;
+    uint64_t seed;
+    string outDir;
+    int startDay;   // days since 1970-01-01 of tomorrow
+    int spanDays;
 
-                    while (true) {
-                        cout << "Enter new date (e.g., YYYY-MM-DD, must be on or after " << CURRENT_DATE << ", or 0 to keep current): ";
-                        getline(cin, newDate);
-                        if (newDate == "0") break;
-                        if (validateDate(newDate)) break;
-                        cout << "Error: Invalid date format (use YYYY-MM-DD) or date is in the past.\n";
-                        ReservationManager::getInstance().logError("Customer", username, "Failed to update reservation",
-                                                                 "Invalid date format or date is in the past.",
-                                                                 reservationId, username, newPhone, newPartySize, newDate);
-                    }
+    static uint64_t mix(uint64_t x) { // splitmix64 finalizer
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
 
-                    while (true) {
-                        cout << "Enter new time (e.g., HH:MM in 24-hour format, must be after "
-                             << (CURRENT_HOUR < 10 ? "0" : "") << CURRENT_HOUR << ":"
-                             << (CURRENT_MINUTE < 10 ? "0" : "") << CURRENT_MINUTE << " if today, or 0 to keep current): ";
-                        getline(cin, newTime);
-                        if (newTime == "0") break;
-                        if (validateTime(newTime, newDate != "0" ? newDate : CURRENT_DATE)) break;
-                        cout << "Error: Invalid time format (use HH:MM) or time is in the past for today.\n";
-                        ReservationManager::getInstance().logError("Customer", username, "Failed to update reservation",
-                                                                 "Invalid time format or time is in the past.",
-                                                                 reservationId, username, newPhone, newPartySize, newDate, newTime);
-                    }
 
-                    while (true) {
-                        cout << "Table options: 0 to keep current, or enter a specific table number (1-10):\n";
-                        ReservationManager::getInstance().viewTableAvailability();
-                        cout << "Choice: ";
-                        getline(cin, newTableChoiceInput);
-                        if (!validateNumericInput(newTableChoiceInput, newTableChoice, 0, 10)) {
-                            cout << "Error: Invalid table choice. Must be a single number between 0 and 10 (e.g., 1, not 1a, 1.1, or 1 1).\n";
-                            ReservationManager::getInstance().logError("Customer", username, "Failed to update reservation",
-                                                                     "Invalid table choice.",
-                                                                     reservationId, username, newPhone, newPartySize, newDate, newTime);
-                            continue;
-                        }
-                        break;
-                    }
+    static void appendPadded(string& out, int value, int width) {
+        char digits[12];
+        auto end = to_chars(digits, digits + sizeof(digits), value).ptr;
+        out.append(max(0, width - static_cast<int>(end - digits)), '0');
+        out.append(digits, end);
+    }
 
-                    string confirm;
-                    cout << "Confirm update? (Y/N or Yes/No): ";
-                    getline(cin, confirm);
-                    if (confirm != "Yes" && confirm != "yes" && confirm != "Y" && confirm != "y") {
-                        cout << "Update cancelled.\n";
-                        break;
-                    }
+    static void appendNumber(string& out, uint64_t value) {
+        char digits[24];
+        out.append(digits, to_chars(digits, digits + sizeof(digits), value).ptr);
+    }
 
-                    try {
-                        if (newTableChoice != 0) {
-                            newTableIndex = newTableChoice - 1;
-                        }
-                        ReservationManager::getInstance().updateReservation(reservationId, username,
-                                                                            newId, newName, newPhone, newPartySize,
-                                                                            newDate, newTime, newTableIndex);
-                        cout << "Reservation updated successfully.\n";
-                    } catch (const ReservationException& ex) {
-                        cout << "Error: " << ex.what() << endl;
-                        ReservationManager::getInstance().logError("Customer", username, "Failed to update reservation",
-                                                                 ex.what(), reservationId, username, newPhone, newPartySize, newDate, newTime, newTableIndex);
-                        cout << "Update failed. Returning to menu.\n";
-                    }
-                    break;
-                }
-                case 5: {
-                    if (!ReservationManager::getInstance().hasReservations(username)) {
-                        cout << "No reservations.\n";
-                        break;
-                    }
+    struct Customer {
+        string username;
+        string fullName;
+        string phone;
+        string password;
+    };
 
-                    bool processComplete = false;
-                    string reservationId;
-                    while (!processComplete) {
-                        try {
-                            cout << "Enter reservation ID to cancel (e.g., ID 1A): ";
-                            getline(cin, reservationId);
-                            reservationId = toUpperCase(reservationId);
+    Customer customer(size_t index) const {
+        static const char* firstNames[] = {
+            "Maria", "James", "Ana", "John", "Sofia", "Michael", "Isabel", "David", "Grace", "Daniel",
+            "Angel", "Mark", "Joy", "Paolo", "Camille", "Miguel", "Andrea", "Carlo", "Bea", "Rafael",
+            "Nicole", "Jose", "Patricia", "Luis", "Kristine", "Adrian", "Hannah", "Gabriel", "Denise", "Vincent"};
+        static const char* lastNames[] = {
+            "Santos", "Reyes", "Cruz", "Garcia", "Mendoza", "Torres", "Flores", "Ramos", "Lopez", "Smith",
+            "Gonzales", "Bautista", "Villanueva", "Aquino", "Johnson", "Castillo", "Rivera", "Lee", "Navarro", "Tan",
+            "Dela Cruz", "Fernandez", "Morales", "Brown", "Chua", "Domingo", "Pascual", "Salazar", "Lim", "Ocampo"};
+        static const char* areaCodes[] = {"917", "918", "919", "927", "928", "939", "945", "966", "977", "995", "212", "415"};
+        const size_t firstCount = size(firstNames), lastCount = size(lastNames);
 
-                            ReservationManager::getInstance().viewCustomerReservations(username);
+        uint64_t h = mix(seed ^ mix(index + 0x100000000ULL));
+        // Squaring a uniform draw skews toward the front of each list: popular names first.
+        const char* first = firstNames[static_cast<size_t>(pow(unit(h), 2.0) * firstCount)];
+        h = mix(h);
+        const char* last = lastNames[static_cast<size_t>(pow(unit(h), 2.0) * lastCount)];
+        h = mix(h);
 
-                            string confirm;
-                            cout << "Confirm cancellation? (Y/N or Yes/No): ";
-                            getline(cin, confirm);
-                            if (confirm != "Yes" && confirm != "yes" && confirm != "Y" && confirm != "y") {
-                                cout << "Cancellation aborted.\n";
-                                processComplete = true;
-                                break;
-                            }
+        Customer c;
+        c.fullName = string(first) + " " + last;
+        for (const char* p = first; *p; ++p) {
+            c.username += static_cast<char>(tolower(static_cast<unsigned char>(*p)));
+        }
+        c.username += '.';
+        for (const char* p = last; *p; ++p) {
+            if (*p != ' ') {
+                c.username += static_cast<char>(tolower(static_cast<unsigned char>(*p)));
+            }
+        }
+        appendNumber(c.username, index + 1);
+        c.phone = areaCodes[h % size(areaCodes)];
+        c.phone += '-';
+        appendPadded(c.phone, static_cast<int>((h >> 8) % 1000), 3);
+        c.phone += '-';
+        appendPadded(c.phone, static_cast<int>((h >> 20) % 10000), 4);
+        char password[17];
+        snprintf(password, sizeof(password), "%08llx", static_cast<unsigned long long>(mix(h) & 0xffffffffULL));
+        c.password = string("pw") + password;
+        return c;
+    }
 
-                            ReservationManager::getInstance().cancelReservation(reservationId, username);
-                            cout << "Reservation cancelled.\n";
-                            processComplete = true;
-                        } catch (const ReservationException& ex) {
-                            cout << "Error: " << ex.what() << endl;
-                            ReservationManager::getInstance().logError("Customer", username, "Failed to cancel reservation",
-                                                                     ex.what(), reservationId, username);
-                            cout << "Please try again.\n";
-                        }
-                    }
-                    break;
-                }
-                case 6: {
-                    string logout;
-                    cout << "Logout? (Y/N or Yes/No): ";
-                    getline(cin, logout);
-                    if (logout == "Yes" || logout == "yes" || logout == "Y" || logout == "y") {
-                        return true;
-                    }
-                    break;
-                }
+    int drawDay(mt19937_64& rng) const {
+        static const double weekdayWeight[7] = {0.55, 1.0, 1.0, 0.75, 0.45, 0.5, 0.55}; // Thu .. Wed (1970-01-01 was a Thursday)
+        while (true) {
+            int day = startDay + static_cast<int>(rng() % spanDays);
+            int y, m, d;
+            civilFromDays(day, y, m, d);
+            double weight = weekdayWeight[((day % 7) + 7) % 7] * (m == 12 ? 1.0 : 0.75);
+            if (unit(rng()) < weight) {
+                return day;
             }
         }
-        return false;
     }
-};
 
-class Receptionist : public User {
 public:
-    bool isValidCredential(const string& input) const {
-        return !input.empty() && all_of(input.begin(), input.end(), [](char c) {
-            return isalnum(c);
-        });
+    // Also used by the demand simulator.
+    static double unit(uint64_t bits) {
+        return (bits >> 11) * (1.0 / 9007199254740992.0);
     }
 
-public:
-    Receptionist(const string& name, const string& password) : User(name, "Receptionist", password) {}
-    bool showMenu() override {
-        bool isRunning = true;
-        while (isRunning) {
-            string input;
-            int choice;
-            cout << "\n[Receptionist Menu - " << username << "]\n";
-            cout << "1. View Reservations\n2. View Table Availability\n3. Exit\nChoice: ";
-            getline(cin, input);
+    static int drawMinutes(mt19937_64& rng) {
+        if (unit(rng()) < 0.25) {
+            return 11 * 60 + 30 + static_cast<int>(rng() % 10) * 15; // lunch 11:30 - 13:45
+        }
+        normal_distribution<double> dinner(19 * 60, 60);
+        int minutes = static_cast<int>(dinner(rng) / 15) * 15;
+        return min(max(minutes, 17 * 60), 21 * 60 + 30);
+    }
 
-            if (!validateNumericInput(input, choice, 1, 3)) {
-                cout << "Invalid choice. Please enter a single number between 1 and 3.\n";
-                continue;
+    static int drawPartySize(mt19937_64& rng) {
+        static const int sizes[] = {1, 2, 3, 4, 5, 6, 7, 8, 10, 12};
+        static const int weights[] = {6, 42, 12, 20, 7, 7, 2, 2, 1, 1}; // out of 100
+        int roll = static_cast<int>(rng() % 100);
+        for (size_t i = 0; i < size(sizes); ++i) {
+            if ((roll -= weights[i]) < 0) {
+                return sizes[i];
             }
+        }
+        return 2;
+    }
 
-            switch (choice) {
-                case 1: {
-                    cout << "\n--- Current Reservations ---\n";
-                    vector<Reservation> allReservations = ReservationManager::getInstance().getAllReservations();
-                    if (allReservations.empty()) {
-                        cout << "No reservations found.\n";
-                    } else {
-                        cout << "ID\t\tCustomer\tParty\tDate\t\tTime\tContact\t\tTable\n";
-                        for (const auto& res : allReservations) {
-                            cout << res.id << "\t"
-                                 << res.customerName << "\t"
-                                 << res.partySize << "\t"
-                                 << res.date << "\t"
-                                 << res.time << "\t"
-                                 << res.phoneNumber << "\t"
-                                 << (res.tableNumber + 1) << endl;
-                        }
-                    }
-                    break;
-                }
-                case 2:
-                    ReservationManager::getInstance().viewTableAvailability();
-                    break;
-                case 3: {
-                    string logout;
-                    cout << "Logout? (Y/N or Yes/No): ";
-                    getline(cin, logout);
-                    if (logout == "Yes" || logout == "yes" || logout == "Y" || logout == "y") {
-                        return true;
-                    }
-                    break;
-                }
+    // Small parties sit at tables 1-4, mid-sized at 5-8, large groups at 9-10.
+    static int drawTable(mt19937_64& rng, int partySize) {
+        if (partySize <= 2) {
+            return static_cast<int>(rng() % 4);
+        }
+        if (partySize <= 6) {
+            return 4 + static_cast<int>(rng() % 4);
+        }
+        return 8 + static_cast<int>(rng() % 2);
+    }
+
+private:
+    void generateChunk(size_t chunk, string& reservations, string& logs) const {
+        mt19937_64 rng(mix(seed ^ mix(chunk)));
+        size_t first = chunk * CHUNK_RECORDS;
+        size_t last = min(reservationCount, first + CHUNK_RECORDS);
+        reservations.reserve((last - first) * 72);
+        logs.reserve((last - first) * 260);
+        for (size_t n = first; n < last; ++n) {
+            // Regulars: squaring favours low customer indices.
+            double u = unit(rng());
+            Customer guest = customer(static_cast<size_t>(u * u * customerCount));
+            bool byReception = unit(rng()) < 0.25;
+            const string& name = byReception ? guest.fullName : guest.username;
+            int partySize = drawPartySize(rng);
+            int table = drawTable(rng, partySize);
+            int y, m, d;
+            civilFromDays(drawDay(rng), y, m, d);
+            int minutes = drawMinutes(rng);
+
+            string id = "ID ";
+            appendNumber(id, n + 1);
+            id += 'A';
+            string date, time;
+            appendPadded(date, y, 4);
+            date += '-';
+            appendPadded(date, m, 2);
+            date += '-';
+            appendPadded(date, d, 2);
+            appendPadded(time, minutes / 60, 2);
+            time += ':';
+            appendPadded(time, minutes % 60, 2);
+
+            reservations += id + "|" + name + "|" + guest.phone + "|";
+            appendNumber(reservations, partySize);
+            reservations += "|" + date + "|" + time + "|";
+            appendNumber(reservations, table);
+            reservations += '\n';
+
+            logs += "Reservation Log\nAction: Reserved table by ";
+            logs += byReception ? "Receptionist: reception" : "Customer: " + guest.username;
+            logs += "\nDetails: #";
+            appendNumber(logs, table + 1);
+            logs += " for ";
+            appendNumber(logs, partySize);
+            logs += " on " + date + " at " + time + "\nID: " + id + " | Name: " + name + " | Contact: " + guest.phone
+                    + " | Party-Size: ";
+            appendNumber(logs, partySize);
+            logs += " | Date: " + date + " | Time: " + time + " | Table: ";
+            appendNumber(logs, table + 1);
+            logs += "\n\n";
+        }
+    }
+
+    int openOutput(const string& file) const {
+        string path = outDir + "/" + file;
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw ReservationException("Unable to open " + path + " for writing.");
+        }
+        return fd;
+    }
+
+    static void writeAt(int fd, const string& data, off_t offset) {
+        size_t done = 0;
+        while (done < data.size()) {
+            ssize_t written = pwrite(fd, data.data() + done, data.size() - done, offset + done);
+            if (written < 0) {
+                throw ReservationException(string("Write failed: ") + strerror(errno));
             }
+            done += written;
         }
-        return false;
     }
-};
 
-class Admin : public User {
 public:
-    Admin(const string& name, const string& password) : User(name, "Admin", password) {}
-    bool showMenu() override {
-        bool isRunning = true;
-        while (isRunning) {
-            string input;
-            int choice;
-            cout << "\n[Admin Menu - " << username << "]\n";
-            cout << "1. View Logs\n";
-            cout << "2. View Customer Reservations\n";
-            cout << "3. View Table Availability\n";
-            cout << "4. Update Reservation\n";
-            cout << "5. Cancel Reservation\n";
-            cout << "6. Create Receptionist Account\n";
-            cout << "7. Log Out\nChoice: ";
-            getline(cin, input);
+    SyntheticBookGenerator(size_t reservations, uint64_t seed, const string& outDir)
+        : reservationCount(reservations), customerCount(max<size_t>(50, reservations / 5)), seed(seed),
+          outDir(outDir) {
+        int y, m, d;
+        sscanf(Clock::read().date.c_str(), "%d-%d-%d", &y, &m, &d);
+        startDay = daysFromCivil(y, m, d) + 1;
+        spanDays = static_cast<int>(max<size_t>(365, reservations / 2000));
+    }
 
-            if (!validateNumericInput(input, choice, 1, 7)) {
-                cout << "Invalid choice. Please enter a single number between 1 and 7.\n";
-                continue;
-            }
+    void run(ostream& out) {
+        if (filesystem::exists(outDir + "/reservations.txt")) {
+            throw ReservationException(outDir + "/reservations.txt already exists; generate into an empty directory.");
+        }
+        filesystem::create_directories(outDir);
+        auto start = chrono::steady_clock::now();
 
-            switch (choice) {
-                case 1:
-                    ReservationManager::getInstance().viewLogs();
-                    break;
-                case 2: {
-                    cout << "\n--- Current Reservations ---\n";
-                    vector<Reservation> allReservations = ReservationManager::getInstance().getAllReservations();
-                    if (allReservations.empty()) {
-                        cout << "No reservations found.\n";
-                    } else {
-                        cout << "ID\t\tCustomer\tParty\tDate\t\tTime\tContact\t\tTable\n";
-                        for (const auto& res : allReservations) {
-                            cout << res.id << "\t"
-                                 << res.customerName << "\t"
-                                 << res.partySize << "\t"
-                                 << res.date << "\t"
-                                 << res.time << "\t"
-                                 << res.phoneNumber << "\t"
-                                 << (res.tableNumber + 1) << endl;
-                        }
-                    }
-                    break;
+        ofstream accounts(outDir + "/customer_accounts.txt");
+        if (!accounts.is_open()) {
+            throw ReservationException("Unable to open customer_accounts.txt for writing.");
+        }
+        for (size_t i = 0; i < customerCount; ++i) {
+            Customer c = customer(i);
+            accounts << c.username << "|" << c.password << "\n";
+        }
+        accounts.close();
+
+        ofstream nextId(outDir + "/next_id.txt");
+        nextId << reservationCount + 1 << "\n";
+        nextId.close();
+
+        int reservationsFd = openOutput("reservations.txt");
+        int logsFd = openOutput("logs.txt");
+        size_t chunks = (reservationCount + CHUNK_RECORDS - 1) / CHUNK_RECORDS;
+        size_t wave = max(1u, thread::hardware_concurrency());
+        off_t reservationsOffset = 0, logsOffset = 0;
+        try {
+            for (size_t firstChunk = 0; firstChunk < chunks; firstChunk += wave) {
+                size_t count = min(wave, chunks - firstChunk);
+                vector<string> reservationParts(count), logParts(count);
+                vector<off_t> reservationOffsets(count), logOffsets(count);
+                vector<future<void>> generated;
+                for (size_t i = 0; i < count; ++i) {
+                    generated.push_back(async(launch::async, [&, i] {
+                        generateChunk(firstChunk + i, reservationParts[i], logParts[i]);
+                    }));
                 }
-                case 3:
-                    ReservationManager::getInstance().viewTableAvailability();
-                    break;
-                case 4: {
-                    vector<Reservation> allReservations = ReservationManager::getInstance().getAllReservations();
-                    if (allReservations.empty()) {
-                        cout << "No reservations.\n";
-                        break;
-                    }
+                for (auto& task : generated) {
+                    task.get();
+                }
+                for (size_t i = 0; i < count; ++i) {
+                    reservationOffsets[i] = reservationsOffset;
+                    logOffsets[i] = logsOffset;
+                    reservationsOffset += reservationParts[i].size();
+                    logsOffset += logParts[i].size();
+                }
+                vector<future<void>> written;
+                for (size_t i = 0; i < count; ++i) {
+                    written.push_back(async(launch::async, [&, i] {
+                        writeAt(reservationsFd, reservationParts[i], reservationOffsets[i]);
+                        writeAt(logsFd, logParts[i], logOffsets[i]);
+                    }));
+                }
+                for (auto& task : written) {
+                    task.get();
+                }
+            }
+        } catch (...) {
+            ::close(reservationsFd);
+            ::close(logsFd);
+            throw;
+        }
+        ::close(reservationsFd);
+        ::close(logsFd);
 
-                    string reservationId, newId, newName, newPhone, newDate, newTime, newPartySizeInput, newTableChoiceInput;
-                    int newPartySize = 0, newTableChoice = 0, newTableIndex = -1;
-                    string customerName;
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        out << "Generated " << reservationCount << " reservations for " << customerCount << " customers in "
+            << outDir << " (" << fixed << setprecision(2) << seconds << "s, "
+            << (reservationsOffset + logsOffset) / (1024 * 1024) << " MiB)\n" << defaultfloat;
+    }
+};
 
-                    while (true) {
-                        cout << "Enter reservation ID to update (e.g., ID 1A): ";
-                        getline(cin, reservationId);
-                        reservationId = toUpperCase(reservationId);
-                        try {
-                            if (!validateReservationId(reservationId)) {
-                                throw ReservationException("Invalid reservation ID format. Use 'ID <number>A', e.g., ID 1A.");
-                            }
-                            bool hasReservation = false;
-                            for (const auto& res : allReservations) {
-                                if (res.id == reservationId) {
-                                    hasReservation = true;
-                                    customerName = res.customerName;
-                                    break;
-                                }
-                            }
-                            if (!hasReservation) {
-                                throw ReservationException("Reservation ID not found.");
-                            }
-                            cout << "\n--- Reservation to Update ---\n";
-                            cout << "ID\t\tCustomer\tParty\tDate\t\tTime\tContact\t\tTable\n";
-                            for (const auto& res : allReservations) {
-                                if (res.id == reservationId) {
-                                    cout << res.id << "\t"
-                                         << res.customerName << "\t"
-                                         << res.partySize << "\t"
-                                         << res.date << "\t"
-                                         << res.time << "\t"
-                                         << res.phoneNumber << "\t"
-                                         << (res.tableNumber + 1) << endl;
-                                    break;
-                                }
-                            }
-                            break;
-                        } catch (const ReservationException& ex) {
-                            cout << "Error: " << ex.what() << endl;
-                            ReservationManager::getInstance().logError("Admin", username, "Failed to update reservation",
-                                                                     ex.what(), reservationId);
-                        }
-                    }
+// -------- Discrete-Event Simulation --------
+// Run with: ./Finals-Interprog --simulate [days] [--seed n]
+// Installs a SimulatedClock and drives a fresh store in a scratch directory through a year
+// (or the given number of days) of synthetic demand, as fast as the engine allows. Each
+// virtual day brings a weekday-weighted number of requests spread over 08:00 to 22:00:
+// bookings for up to a month ahead, cancellations and availability checks. The clock is
+// moved to each request's time before the engine sees it, so "in the past" checks behave
+// as they would live. Guests are assumed to turn up, so no-show release is off. The report
+// gives per-month demand, acceptance and occupancy (table-hours booked over table-hours
+// open, 11:00 to 23:00) and engine throughput.
+class DemandSimulator {
+private:
+    static const int TABLES = 10; // the floor every ReservationManager starts with
+    static const int OPEN_MINUTE = 11 * 60;
+    static const int CLOSE_MINUTE = 23 * 60;
 
-                    while (true) {
-                        cout << "Enter new ID (e.g., ID 2A, or 0 to keep current): ";
-                        getline(cin, newId);
-                        newId = toUpperCase(newId);
-                        if (newId == "0") break;
-                        try {
-                            if (!validateReservationId(newId)) {
-                                throw ReservationException("Invalid new reservation ID format. Use 'ID <number>A', e.g., ID 1A.");
-                            }
-                            if (ReservationManager::getInstance().reservationIdExists(newId, reservationId)) {
-                                throw ReservationException("New reservation ID already exists. Choose a different ID.");
-                            }
-                            break;
-                        } catch (const ReservationException& ex) {
-                            cout << "Error: " << ex.what() << endl;
-                            ReservationManager::getInstance().logError("Admin", username, "Failed to update reservation",
-                                                                     ex.what(), reservationId);
-                        }
-                    }
+    int days;
+    uint64_t seed;
 
-                    while (true) {
-                        cout << "Enter new name (or 0 to keep current): ";
-                        getline(cin, newName);
-                        break;
-                    }
+    struct Month {
+        long requests = 0;
+        long booked = 0;
+        long rejected = 0;
+        long cancelled = 0;
+        double occupancySum = 0;
+        int days = 0;
+    };
 
-                    while (true) {
-                        cout << "Enter new phone number (e.g., 123-456-7890, or 0 to keep current): ";
-                        getline(cin, newPhone);
-                        if (newPhone == "0") break;
-                        if (validatePhoneNumber(newPhone)) break;
-                        cout << "Error: Invalid phone number format. Use XXX-XXX-XXXX.\n";
-                        ReservationManager::getInstance().logError("Admin", username, "Failed to update reservation",
-                                                                 "Invalid phone number format.", reservationId, newName, newPhone);
-                    }
+    // Share of the day's opening hours each table is held for.
+    static double occupancy(const vector<Reservation>& sheet) {
+        long heldMinutes = 0;
+        for (const auto& res : sheet) {
+            int begin = timeToSlot(res.time) * SLOT_MINUTES;
+            int end = begin + RESERVATION_SLOTS * SLOT_MINUTES;
+            heldMinutes += max(0, min(end, CLOSE_MINUTE) - max(begin, OPEN_MINUTE));
+        }
+        return static_cast<double>(heldMinutes) / (TABLES * (CLOSE_MINUTE - OPEN_MINUTE));
+    }
 
-                    while (true) {
-                        cout << "Enter new party size (must be at least 1, or 0 to keep current): ";
-                        getline(cin, newPartySizeInput);
-                        if (newPartySizeInput == "0") {
-                            newPartySize = 0;
-                            break;
-                        }
-                        if (!validateNumericInput(newPartySizeInput, newPartySize, 1, INT_MAX)) {
-                            cout << "Error: Invalid party size. Must be a single number >= 1 (e.g., 2, not 2a, 2.1, or 2 2).\n";
-                            ReservationManager::getInstance().logError("Admin", username, "Failed to update reservation",
-                                                                     "Invalid party size.", reservationId, newName, newPhone, newPartySize);
-                            continue;
-                        }
-                        if (!validatePartySize(newPartySize)) {
-                            cout << "Error: Party size must be at least 1.\n";
-                            ReservationManager::getInstance().logError("Admin", username, "Failed to update reservation",
-                                                                     "Party size must be at least 1.", reservationId, newName, newPhone, newPartySize);
-                            continue;
-                        }
-                        break;
-                    }
+public:
+    DemandSimulator(int days, uint64_t seed) : days(days), seed(seed) {}
 
-                    while (true) {
-                        cout << "Enter new date (e.g., YYYY-MM-DD, must be on or after " << CURRENT_DATE << ", or 0 to keep current): ";
-                        getline(cin, newDate);
-                        if (newDate == "0") break;
-                        if (validateDate(newDate)) break;
-                        cout << "Error: Invalid date format (use YYYY-MM-DD) or date is in the past.\n";
-                        ReservationManager::getInstance().logError("Admin", username, "Failed to update reservation",
-                                                                 "Invalid date format or date is in the past.",
-                                                                 reservationId, newName, newPhone, newPartySize, newDate);
-                    }
+    bool run(ostream& out) {
+        ScratchDirectory scratch("simulation");
+        if (!scratch.entered()) {
+            cerr << "Error: Unable to create a scratch directory.\n";
+            return false;
+        }
+        int y, m, d;
+        sscanf(Clock::read().date.c_str(), "%d-%d-%d", &y, &m, &d);
+        int firstDay = daysFromCivil(y, m, d);
+        SimulatedClock* clock = new SimulatedClock(static_cast<int64_t>(firstDay) * 1440);
+        Clock::install(unique_ptr<Clock>(clock));
+        ReservationTimers::noShowGraceMinutes = 0; // arrivals are not modelled, so nobody would ever check in
+        ReservationManager& venue = VenueRegistry::getInstance().venue(VenueRegistry::getInstance().defaultVenue());
 
-                    while (true) {
-                        cout << "Enter new time (e.g., HH:MM in 24-hour format, must be after "
-                             << (CURRENT_HOUR < 10 ? "0" : "") << CURRENT_HOUR << ":"
-                             << (CURRENT_MINUTE < 10 ? "0" : "") << CURRENT_MINUTE << ", or 0 to keep current): ";
-                        getline(cin, newTime);
-                        if (newTime == "0") break;
-                        if (validateTime(newTime, newDate != "0" ? newDate : CURRENT_DATE)) break;
-                        cout << "Error: Invalid time format (use HH:MM) or time is in the past for today.\n";
-                        ReservationManager::getInstance().logError("Admin", username, "Failed to update reservation",
-                                                                 "Invalid time format or time is in the past.",
-                                                                 reservationId, newName, newPhone, newPartySize, newDate, newTime);
-                    }
+        static const double weekdayDemand[7] = {45, 60, 70, 50, 25, 30, 35}; // Thu .. Wed
+        mt19937_64 rng(seed);
+        vector<pair<string, int>> held; // reservation ID and its day, for cancellations
+        map<string, Month> months;
+        vector<double> latencies;
+        long calls = 0, guest = 0;
+        double engineSeconds = 0;
+        auto wallStart = chrono::steady_clock::now();
 
-                    while (true) {
-                        cout << "Table options: 0 to keep current, or enter a specific table number (1-10):\n";
-                        ReservationManager::getInstance().viewTableAvailability();
-                        cout << "Choice: ";
-                        getline(cin, newTableChoiceInput);
-                        if (!validateNumericInput(newTableChoiceInput, newTableChoice, 0, 10)) {
-                            cout << "Error: Invalid table choice. Must be a single number between 0 and 10 (e.g., 1, not 1a, 1.1, or 1 1).\n";
-                            ReservationManager::getInstance().logError("Admin", username, "Failed to update reservation",
-                                                                     "Invalid table choice.",
-                                                                     reservationId, newName, newPhone, newPartySize, newDate, newTime);
-                            continue;
-                        }
-                        break;
-                    }
+        auto timed = [&](const function<void()>& call) {
+            auto began = chrono::steady_clock::now();
+            bool ok = true;
+            try {
+                call();
+            } catch (const ReservationException&) {
+                ok = false;
+            }
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - began).count();
+            engineSeconds += seconds;
+            latencies.push_back(seconds);
+            calls++;
+            return ok;
+        };
 
-                    string confirm;
-                    cout << "Confirm update? (Y/N or Yes/No): ";
-                    getline(cin, confirm);
-                    if (confirm != "Yes" && confirm != "yes" && confirm != "Y" && confirm != "y") {
-                        cout << "Update cancelled.\n";
-                        break;
-                    }
+        for (int day = firstDay; day < firstDay + days; ++day) {
+            string today = dateFromDays(day);
+            Month& month = months[today.substr(0, 7)];
+            poisson_distribution<int> arrivals(weekdayDemand[((day % 7) + 7) % 7]);
+            vector<int> minutes(arrivals(rng));
+            for (auto& minute : minutes) {
+                minute = 8 * 60 + static_cast<int>(rng() % (14 * 60));
+            }
+            sort(minutes.begin(), minutes.end());
 
-                    try {
-                        if (newTableChoice != 0) {
-                            newTableIndex = newTableChoice - 1;
-                        }
-                        ReservationManager::getInstance().updateReservation(reservationId, customerName,
-                                                                            newId, newName, newPhone, newPartySize,
-                                                                            newDate, newTime, newTableIndex);
-                        cout << "Reservation updated successfully.\n";
-                        ReservationManager::getInstance().logReservationAction("Admin", username, "Updated reservation",
-                                                                             "ID " + reservationId);
-                    } catch (const ReservationException& ex) {
-                        cout << "Error: " << ex.what() << endl;
-                        ReservationManager::getInstance().logError("Admin", username, "Failed to update reservation",
-                                                                 ex.what(), reservationId, newName, newPhone, newPartySize, newDate, newTime, newTableIndex);
-                        cout << "Update failed. Returning to menu.\n";
+            for (int minute : minutes) {
+                clock->advanceTo(static_cast<int64_t>(day) * 1440 + minute);
+                double roll = SyntheticBookGenerator::unit(rng());
+                double ahead = SyntheticBookGenerator::unit(rng());
+                int targetDay = day + static_cast<int>(ahead * ahead * 31);
+                string date = dateFromDays(targetDay);
+                if (roll < 0.8) {
+                    month.requests++;
+                    int partySize = SyntheticBookGenerator::drawPartySize(rng);
+                    int table = SyntheticBookGenerator::drawTable(rng, partySize);
+                    string time = slotToTime(SyntheticBookGenerator::drawMinutes(rng) / SLOT_MINUTES);
+                    string name = "Guest " + to_string(++guest);
+                    char phone[16];
+                    snprintf(phone, sizeof(phone), "555-%03d-%04d", static_cast<int>(rng() % 1000), static_cast<int>(rng() % 10000));
+                    bool booked = timed([&] {
+                        auto shard = venue.access();
+                        shard->reserveTable(name, phone, partySize, date, time, table);
+                        held.emplace_back("ID " + to_string(shard->getNextReservationId() - 1) + "A", targetDay);
+                    });
+                    (booked ? month.booked : month.rejected)++;
+                } else if (roll < 0.88) {
+                    if (held.empty()) {
+                        continue;
                     }
-                    break;
-                }
-                case 5: {
-                    vector<Reservation> allReservations = ReservationManager::getInstance().getAllReservations();
-                    if (allReservations.empty()) {
-                        cout << "No reservations.\n";
-                        break;
+                    size_t pick = rng() % held.size();
+                    pair<string, int> victim = held[pick];
+                    held[pick] = held.back();
+                    held.pop_back();
+                    if (victim.second < day) {
+                        continue; // already happened
                     }
+                    if (timed([&] { venue.access()->cancelReservation(victim.first, "simulator"); })) {
+                        month.cancelled++;
+                    }
+                } else {
+                    ostringstream sink;
+                    timed([&] { venue.access()->viewAvailabilityHeatmap(sink, date); });
+                }
+            }
+            clock->advanceTo(static_cast<int64_t>(day) * 1440 + CLOSE_MINUTE);
+            month.occupancySum += occupancy(venue.access()->getDaySheet(today));
+            month.days++;
+        }
+        double wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - wallStart).count();
 
-                    bool processComplete = false;
-                    string reservationId;
-                    while (!processComplete) {
-                        try {
-                            string customerName;
-                            cout << "Enter reservation ID to cancel (e.g., ID 1A): ";
-                            getline(cin, reservationId);
-                            reservationId = toUpperCase(reservationId);
+        out << left << setw(9) << "Month" << right << setw(10) << "Requests" << setw(8) << "Booked" << setw(10)
+            << "Rejected" << setw(11) << "Cancelled" << setw(11) << "Occupancy" << "\n";
+        for (const auto& entry : months) {
+            const Month& month = entry.second;
+            out << left << setw(9) << entry.first << right << setw(10) << month.requests << setw(8) << month.booked
+                << setw(10) << month.rejected << setw(11) << month.cancelled << setw(10) << fixed << setprecision(1)
+                << 100.0 * month.occupancySum / max(1, month.days) << "%\n" << defaultfloat;
+        }
+        sort(latencies.begin(), latencies.end());
+        double p99 = latencies.empty() ? 0.0 : latencies[static_cast<size_t>(0.99 * (latencies.size() - 1))];
+        out << "Simulated " << days << " days (" << calls << " engine calls) in " << fixed << setprecision(2) << wallSeconds
+            << "s: " << setprecision(0) << days / max(wallSeconds, 1e-9) << " days/s, "
+            << calls / max(engineSeconds, 1e-9) << " calls/s in the engine, p99 " << setprecision(3) << p99 * 1000
+            << "ms\n" << defaultfloat;
+        return true;
+    }
+};
 
-                            if (!validateReservationId(reservationId)) {
-                                throw ReservationException("Invalid reservation ID format. Use 'ID <number>A', e.g., ID 1A.");
-                            }
-                            bool found = false;
-                            for (const auto& res : allReservations) {
-                                if (res.id == reservationId) {
-                                    customerName = res.customerName;
-                                    found = true;
-                                    break;
-                                }
-                            }
-                            if (!found) {
-                                throw ReservationException("Reservation ID not found.");
-                            }
+// -------- Traffic Replay --------
+// Run with: ./Finals-Interprog --replay <trace> [--speed <factor>|max]
+// Re-executes a capture against a fresh store in a scratch directory. Each thread of the
+// original run gets a replay thread that issues its calls in order, at the original
+// offsets divided by the speed factor, or back to back with "max". The report compares
+// per-op latency with the capture and counts calls whose outcome (returned or threw)
+// differs, which is where a new build behaves differently on the same night.
+class TrafficReplay {
+private:
+    vector<TrafficCapture::Record> records;
+    double speed; // 0 replays as fast as possible
 
-                            cout << "\n--- Reservation to Cancel ---\n";
-                            cout << "ID\t\tCustomer\tParty\tDate\t\tTime\tContact\t\tTable\n";
-                            for (const auto& res : allReservations) {
-                                if (res.id == reservationId) {
-                                    cout << res.id << "\t"
-                                         << res.customerName << "\t"
-                                         << res.partySize << "\t"
-                                         << res.date << "\t"
-                                         << res.time << "\t"
-                                         << res.phoneNumber << "\t"
-                                         << (res.tableNumber + 1) << endl;
-                                    break;
-                                }
-                            }
+    struct Outcome {
+        bool ok = false;
+        uint64_t durationMicros = 0;
+    };
 
-                            string confirm;
-                            cout << "Confirm cancellation? (Y/N or Yes/No): ";
-                            getline(cin, confirm);
-                            if (confirm != "Yes" && confirm != "yes" && confirm != "Y" && confirm != "y") {
-                                cout << "Cancellation aborted.\n";
-                                processComplete = true;
-                                break;
-                            }
+    static void execute(ReservationManager& venue, const TrafficCapture::Record& call) {
+        const vector<string>& s = call.strings;
+        const vector<int64_t>& n = call.ints;
+        ostringstream sink;
+        auto shard = venue.access();
+        switch (call.op) {
+            case TrafficCapture::RESERVE:
+                shard->reserveTable(s[0], s[1], n[0], s[2], s[3], n[1]);
+                break;
+            case TrafficCapture::UPDATE:
+                shard->updateReservation(s[0], s[1], s[2], s[3], s[4], n[0], s[5], s[6], n[1]);
+                break;
+            case TrafficCapture::CANCEL:
+                shard->cancelReservation(s[0], s[1]);
+                break;
+            case TrafficCapture::GET:
+                shard->getReservation(s[0]);
+                break;
+            case TrafficCapture::FIND_BY_PHONE:
+                shard->findReservationsByPhone(s[0]);
+                break;
+            case TrafficCapture::SEARCH_BY_NAME:
+                shard->searchCustomersByName(s[0], n[0]);
+                break;
+            case TrafficCapture::BETWEEN:
+                shard->getReservationsBetween(s[0], s[1]);
+                break;
+            case TrafficCapture::DAY_SHEET:
+                shard->getDaySheet(s[0]);
+                break;
+            case TrafficCapture::CUSTOMER_RESERVATIONS:
+                shard->viewCustomerReservations(sink, s[0]);
+                break;
+            case TrafficCapture::HAS_RESERVATIONS:
+                shard->hasReservations(s[0]);
+                break;
+            case TrafficCapture::AVAILABILITY:
+                shard->viewTableAvailability(sink);
+                break;
+            case TrafficCapture::HEATMAP:
+                shard->viewAvailabilityHeatmap(sink, s[0]);
+                break;
+            case TrafficCapture::ALL_RESERVATIONS:
+                shard->getAllReservations();
+                break;
+            case TrafficCapture::VIEW_LOGS:
+                shard->viewLogs(sink);
+                break;
+            default:
+                break;
+        }
+    }
 
-                            ReservationManager::getInstance().cancelReservation(reservationId, customerName);
-                            cout << "Reservation cancelled.\n";
-                            ReservationManager::getInstance().logReservationAction("Admin", username, "Cancelled reservation",
-                                                                                 "ID " + reservationId);
-                            processComplete = true;
-                        } catch (const ReservationException& ex) {
-                            cout << "Error: " << ex.what() << endl;
-                            ReservationManager::getInstance().logError("Admin", username, "Failed to cancel reservation",
-                                                                     ex.what(), reservationId);
-                            cout << "Please try again.\n";
-                        }
-                    }
-                    break;
-                }
-                case 6: {
-                    string recUsername, recPassword;
-                    bool usernameValid = false;
-                    while (!usernameValid) {
-                        cout << "Enter new receptionist username (no spaces allowed): ";
-                        getline(cin, recUsername);
-                        if (!isValidCredential(recUsername)) {
-                            cout << "Error: Username cannot be empty or contain spaces.\n";
-                            continue;
-                        }
-                        if (receptionistAccounts.count(recUsername)) {
-                            cout << "Username already exists. Please choose a different username.\n";
-                            continue;
-                        }
-                        usernameValid = true;
-                    }
-                    bool passwordValid = false;
-                    while (!passwordValid) {
-                        cout << "Enter password (no spaces allowed): ";
-                        getline(cin, recPassword);
-                        if (!isValidCredential(recPassword)) {
-                            cout << "Error: Password cannot be empty or contain spaces.\n";
-                            continue;
+public:
+    TrafficReplay(vector<TrafficCapture::Record> trace, double speed) : records(std::move(trace)), speed(speed) {
+        stable_sort(records.begin(), records.end(), [](const auto& a, const auto& b) {
+            return a.startMicros < b.startMicros;
+        });
+    }
+
+    bool run(ostream& out) {
+        ScratchDirectory scratch("replay");
+        if (!scratch.entered()) {
+            cerr << "Error: Unable to create a scratch directory.\n";
+            return false;
+        }
+        vector<string> venues;
+        map<uint32_t, vector<size_t>> byThread; // original thread -> record positions, in start order
+        for (size_t i = 0; i < records.size(); ++i) {
+            if (find(venues.begin(), venues.end(), records[i].venue) == venues.end()) {
+                venues.push_back(records[i].venue);
+            }
+            byThread[records[i].thread].push_back(i);
+        }
+        ofstream venuesFile("venues.txt");
+        for (const auto& id : venues) {
+            venuesFile << id << "\n";
+        }
+        venuesFile.close();
+        VenueRegistry& registry = VenueRegistry::getInstance();
+
+        vector<Outcome> outcomes(records.size());
+        atomic<uint64_t> maxLagMicros{0};
+        auto start = chrono::steady_clock::now();
+        vector<thread> threads;
+        for (const auto& lane : byThread) {
+            const vector<size_t>& positions = lane.second;
+            threads.emplace_back([&, positions] {
+                for (size_t i : positions) {
+                    const TrafficCapture::Record& call = records[i];
+                    if (speed > 0) {
+                        auto due = start + chrono::microseconds(static_cast<uint64_t>(call.startMicros / speed));
+                        this_thread::sleep_until(due);
+                        uint64_t lag = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - due).count();
+                        uint64_t seen = maxLagMicros;
+                        while (lag > seen && !maxLagMicros.compare_exchange_weak(seen, lag)) {
                         }
-                        passwordValid = true;
                     }
-                    receptionistAccounts[recUsername] = recPassword;
-                    cout << "Receptionist account created.\n";
-                    ReservationManager::getInstance().logReservationAction("Admin", username, "Created receptionist account",
-                                                                         "Username: " + recUsername);
-                    break;
-                }
-                case 7: {
-                    string logout;
-                    cout << "Logout? (Y/N or Yes/No): ";
-                    getline(cin, logout);
-                    if (logout == "Yes" || logout == "yes" || logout == "Y" || logout == "y") {
-                        return true;
+                    auto began = chrono::steady_clock::now();
+                    try {
+                        execute(registry.venue(call.venue), call);
+                        outcomes[i].ok = true;
+                    } catch (const exception&) {
+                        outcomes[i].ok = false;
                     }
-                    break;
+                    outcomes[i].durationMicros =
+                        chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - began).count();
                 }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        struct OpStats {
+            vector<uint64_t> captured, replayed;
+            size_t mismatches = 0;
+        };
+        map<int, OpStats> perOp;
+        size_t mismatches = 0;
+        for (size_t i = 0; i < records.size(); ++i) {
+            OpStats& stats = perOp[records[i].op];
+            stats.captured.push_back(records[i].durationMicros);
+            stats.replayed.push_back(outcomes[i].durationMicros);
+            if (outcomes[i].ok != records[i].ok) {
+                stats.mismatches++;
+                mismatches++;
             }
         }
-        return false;
+        auto percentile = [](vector<uint64_t>& values, double p) {
+            sort(values.begin(), values.end());
+            return values[static_cast<size_t>(p * (values.size() - 1))];
+        };
+        double span = records.empty() ? 0.0 : records.back().startMicros / 1e6;
+        out << "Replayed " << records.size() << " calls from " << byThread.size() << " threads in " << fixed
+            << setprecision(2) << seconds << "s (captured over " << span << "s, "
+            << setprecision(0) << records.size() / max(seconds, 1e-9) << " calls/s";
+        if (speed > 0) {
+            out << ", max lag " << setprecision(1) << maxLagMicros / 1000.0 << "ms";
+        }
+        out << ")\n" << defaultfloat;
+        out << left << setw(24) << "op" << right << setw(8) << "calls" << setw(12) << "p50 (us)" << setw(12)
+            << "replay p50" << setw(12) << "p99 (us)" << setw(12) << "replay p99" << setw(12) << "mismatches" << "\n";
+        for (auto& entry : perOp) {
+            OpStats& stats = entry.second;
+            out << left << setw(24) << TrafficCapture::opName(static_cast<TrafficCapture::Op>(entry.first)) << right
+                << setw(8) << stats.captured.size() << setw(12) << percentile(stats.captured, 0.5) << setw(12)
+                << percentile(stats.replayed, 0.5) << setw(12) << percentile(stats.captured, 0.99) << setw(12)
+                << percentile(stats.replayed, 0.99) << setw(12) << stats.mismatches << "\n";
+        }
+        return mismatches == 0;
     }
 };
 
-// -------- Main Driver --------
-int main() {
+// -------- Session Engine --------
+// Role selection and the menus behind it, for one session.
+Task<void> runSession(Session& session) {
     const string adminUsername = "admin";
     const string adminPassword = "admin123";
+    ostream& out = session.out();
 
-    loadCustomerAccounts(customerAccounts);
+    // Venue selection only appears when venues.txt lists more than one venue.
+    const vector<string>& venueIds = VenueRegistry::getInstance().venueIds();
+    string venueId = VenueRegistry::getInstance().defaultVenue();
+    while (venueIds.size() > 1) {
+        string input;
+        int venueChoice;
+        out << "\n[Venue Selection]\n";
+        for (size_t i = 0; i < venueIds.size(); ++i) {
+            out << i + 1 << ". " << venueIds[i] << "\n";
+        }
+        out << "Choose venue: ";
+        co_await session.readLine(input);
+        if (validateNumericInput(input, venueChoice, 1, venueIds.size())) {
+            venueId = venueIds[venueChoice - 1];
+            break;
+        }
+        out << "Invalid choice. Please enter a single number between 1 and " << venueIds.size() << ".\n";
+    }
 
     bool isRunning = true;
     while (isRunning) {
         string input;
         int roleChoice;
-        cout << "\n[Role Selection]\n1. Receptionist\n2. Customer\n3. Admin\n4. Exit\nChoose role: ";
-        getline(cin, input);
+        out << "\n[Role Selection]\n1. Receptionist\n2. Customer\n3. Admin\n4. Exit\nChoose role: ";
+        co_await session.readLine(input);
 
         if (!validateNumericInput(input, roleChoice, 1, 4)) {
-            cout << "Invalid choice. Please enter a single number between 1 and 4.\n";
+            out << "Invalid choice. Please enter a single number between 1 and 4.\n";
             continue;
         }
 
@@ -1358,24 +8818,24 @@ int main() {
                 bool credentialsValid = false;
                 string username, password;
                 while (!credentialsValid) {
-                    cout << "Enter Receptionist username: ";
-                    getline(cin, username);
-                    Receptionist temp(username, "");
+                    out << "Enter Receptionist username: ";
+                    co_await session.readLine(username);
+                    Receptionist temp(username, "", venueId);
                     if (!temp.isValidCredential(username)) {
-                        cout << "Invalid username. Use letters and numbers only (no spaces or special characters).\n";
+                        out << "Invalid username. Use letters and numbers only (no spaces or special characters).\n";
                         continue;
                     }
-                    cout << "Enter password: ";
-                    getline(cin, password);
+                    out << "Enter password: ";
+                    co_await session.readLine(password);
                     if (!temp.isValidCredential(password)) {
-                        cout << "Invalid password. Use letters and numbers only (no spaces or special characters).\n";
+                        out << "Invalid password. Use letters and numbers only (no spaces or special characters).\n";
                         continue;
                     }
                     if (receptionistAccounts.count(username) && receptionistAccounts[username] == password) {
-                        user = unique_ptr<Receptionist>(new Receptionist(username, password));
+                        user = unique_ptr<Receptionist>(new Receptionist(username, password, venueId));
                         credentialsValid = true;
                     } else {
-                        cout << "Invalid receptionist credentials. Please try again.\n";
+                        out << "Invalid receptionist credentials. Please try again.\n";
                     }
                 }
                 break;
@@ -1384,18 +8844,18 @@ int main() {
                 int custOption;
                 string custInput;
                 while (true) {
-                    cout << "\n1. Create Customer Account\n2. Login to Customer Account\nChoice: ";
-                    getline(cin, custInput);
+                    out << "\n1. Create Customer Account\n2. Login to Customer Account\nChoice: ";
+                    co_await session.readLine(custInput);
                     if (validateNumericInput(custInput, custOption, 1, 2)) {
                         break;
                     }
-                    cout << "Invalid choice. Please enter a single number between 1 and 2.\n";
+                    out << "Invalid choice. Please enter a single number between 1 and 2.\n";
                 }
 
                 if (custOption == 1) {
-                    user = unique_ptr<Customer>(new Customer(true));
+                    user = co_await Customer::signIn(session, true, venueId);
                 } else if (custOption == 2) {
-                    user = unique_ptr<Customer>(new Customer(false));
+                    user = co_await Customer::signIn(session, false, venueId);
                 }
                 break;
             }
@@ -1403,15 +8863,15 @@ int main() {
                 bool credentialsValid = false;
                 string username, password;
                 while (!credentialsValid) {
-                    cout << "Enter Admin username: ";
-                    getline(cin, username);
-                    cout << "Enter Admin password: ";
-                    getline(cin, password);
+                    out << "Enter Admin username: ";
+                    co_await session.readLine(username);
+                    out << "Enter Admin password: ";
+                    co_await session.readLine(password);
                     if (username == adminUsername && password == adminPassword) {
-                        user = unique_ptr<Admin>(new Admin(username, password));
+                        user = unique_ptr<Admin>(new Admin(username, password, venueId));
                         credentialsValid = true;
                     } else {
-                        cout << "Invalid admin credentials. Please try again.\n";
+                        out << "Invalid admin credentials. Please try again.\n";
                     }
                 }
                 break;
@@ -1422,13 +8882,506 @@ int main() {
         }
 
         if (user) {
-            bool logout = user->showMenu();
+            bool logout = co_await user->showMenu(session);
             if (logout) {
                 user.reset();
                 continue;
             }
         }
     }
+}
 
-    return 0;
+// Console sessions: the only input source is stdin, so each line is handed straight to
+// the suspended flow. Ends when the user exits or stdin closes; false if the flow ended
+// with an error.
+bool runConsoleSession() {
+    Session session(cout);
+    Task<void> flow = runSession(session);
+    flow.start();
+    string line;
+    while (!flow.done() && readLine(line)) {
+        session.deliverLine(line);
+    }
+    TerminalWriter::flush();
+    if (flow.done() && flow.error()) {
+        cerr << "Session ended with an error.\n";
+        return false;
+    }
+    return true;
+}
+
+// Socket sessions: a single-threaded epoll reactor multiplexes every connection. Each
+// connection owns a session whose output is buffered and drained as the socket allows,
+// so a slow client never blocks the others.
+class SessionServer {
+private:
+    struct Connection {
+        int fd;
+        ostringstream output;
+        Session session;
+        Task<void> flow;
+        string unsent;
+
+        explicit Connection(int socket) : fd(socket), session(output), flow(runSession(session)) {}
+    };
+
+    int listenFd = -1;
+    int epollFd = -1;
+    unordered_map<int, unique_ptr<Connection>> connections;
+    atomic<size_t> openConnections{0}; // connections.size(), readable from any thread
+    unordered_map<int, function<bool()>> watchedFds; // other sockets served by this reactor
+
+    // Flows suspended on a replica read come back through here.
+    struct Completion {
+        coroutine_handle<> flow;
+        shared_ptr<bool> alive;
+        int fd;
+    };
+    ReadReplicaPool* replicas = nullptr;
+    int completionFd = -1;
+    mutex completionsMutex;
+    vector<Completion> completions;
+
+    bool resumeCompleted() {
+        uint64_t count;
+        while (::read(completionFd, &count, sizeof(count)) > 0) {
+        }
+        vector<Completion> ready;
+        {
+            lock_guard<mutex> lock(completionsMutex);
+            ready.swap(completions);
+        }
+        for (const auto& completion : ready) {
+            if (!*completion.alive) {
+                continue; // the connection closed while the query was running
+            }
+            completion.flow.resume();
+            auto it = connections.find(completion.fd);
+            if (it != connections.end()) {
+                flush(*it->second);
+            }
+        }
+        return true;
+    }
+
+    static void setNonBlocking(int fd) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    }
+
+    void close(Connection& connection) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+        ::close(connection.fd);
+        connections.erase(connection.fd);
+        openConnections--;
+    }
+
+    // Returns false once the connection has been closed.
+    bool flush(Connection& connection) {
+        connection.unsent += connection.output.str();
+        connection.output.str("");
+        while (!connection.unsent.empty()) {
+            ssize_t written = send(connection.fd, connection.unsent.data(), connection.unsent.size(), MSG_NOSIGNAL);
+            if (written < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    break;
+                }
+                close(connection);
+                return false;
+            }
+            connection.unsent.erase(0, written);
+        }
+        if (connection.flow.done() && connection.unsent.empty()) {
+            if (connection.flow.error()) {
+                cerr << "Session ended with an error.\n";
+            }
+            close(connection);
+            return false;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN | (connection.unsent.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT));
+        event.data.fd = connection.fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+        return true;
+    }
+
+    void accept() {
+        while (true) {
+            int fd = ::accept(listenFd, nullptr, nullptr);
+            if (fd < 0) {
+                return;
+            }
+            setNonBlocking(fd);
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+            Connection& connection = *connections.emplace(fd, make_unique<Connection>(fd)).first->second;
+            openConnections++;
+            if (replicas) {
+                connection.session.routeReads(replicas, [this, fd](coroutine_handle<> flow, shared_ptr<bool> alive) {
+                    {
+                        lock_guard<mutex> lock(completionsMutex);
+                        completions.push_back({flow, std::move(alive), fd});
+                    }
+                    uint64_t one = 1;
+                    ::write(completionFd, &one, sizeof(one));
+                });
+            }
+            connection.flow.start();
+            flush(connection);
+        }
+    }
+
+    void read(Connection& connection) {
+        char buffer[4096];
+        while (true) {
+            ssize_t received = recv(connection.fd, buffer, sizeof(buffer), 0);
+            if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+                close(connection);
+                return;
+            }
+            if (received < 0) {
+                break;
+            }
+            if (!connection.flow.done()) {
+                connection.session.feed(buffer, received);
+            }
+        }
+        flush(connection);
+    }
+
+public:
+    ~SessionServer() {
+        MemoryAccounting::unregisterSource("session_table", "connections");
+        for (auto& entry : connections) {
+            ::close(entry.first);
+        }
+        if (epollFd >= 0) {
+            ::close(epollFd);
+        }
+        if (completionFd >= 0) {
+            ::close(completionFd);
+        }
+        if (listenFd >= 0) {
+            ::close(listenFd);
+        }
+    }
+
+    bool listen(int port) {
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+            || ::listen(listenFd, SOMAXCONN) < 0) {
+            cerr << "Error: Unable to listen on port " << port << ".\n";
+            return false;
+        }
+        setNonBlocking(listenFd);
+        epollFd = epoll_create1(0);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = listenFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+        MemoryAccounting::registerSource("session_table", "connections", [this] {
+            size_t open = openConnections;
+            return MemoryAccounting::Footprint{open * (HASH_NODE_OVERHEAD + sizeof(pair<const int, unique_ptr<Connection>>)
+                                                       + sizeof(Connection)), open};
+        });
+        return true;
+    }
+
+    // Sends listing, search and report reads to the pool instead of the primary.
+    void useReadReplicas(ReadReplicaPool* pool) {
+        replicas = pool;
+        completionFd = eventfd(0, EFD_NONBLOCK);
+        watch(completionFd, [this] { return resumeCompleted(); });
+    }
+
+    // onReadable runs on the reactor thread whenever fd has input; returning false stops
+    // watching it.
+    void watch(int fd, function<bool()> onReadable) {
+        watchedFds[fd] = std::move(onReadable);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    void run() {
+        epoll_event events[64];
+        while (true) {
+            int ready = epoll_wait(epollFd, events, 64, -1);
+            if (ready < 0 && errno != EINTR) {
+                return;
+            }
+            for (int i = 0; i < ready; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == listenFd) {
+                    accept();
+                    continue;
+                }
+                auto watched = watchedFds.find(fd);
+                if (watched != watchedFds.end()) {
+                    if (!watched->second()) {
+                        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+                        watchedFds.erase(watched);
+                    }
+                    continue;
+                }
+                auto it = connections.find(fd);
+                if (it == connections.end()) {
+                    continue;
+                }
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    read(*it->second);
+                } else if (events[i].events & EPOLLOUT) {
+                    flush(*it->second);
+                }
+            }
+        }
+    }
+};
+
+// -------- Main Driver --------
+int main(int argc, char* argv[]) {
+    if ((argc == 3 || argc == 4) && string(argv[1]) == "--bench") {
+        return runBenchmark(argv[2], argc == 4 ? argv[3] : "") ? 0 : 1;
+    }
+    if ((argc == 3 || (argc == 5 && string(argv[3]) == "--out")) && string(argv[1]) == "--rebuild-from-logs") {
+        return rebuildStoreFromLogs(argv[2], argc == 5 ? argv[4] : ".", cout) ? 0 : 1;
+    }
+    if (argc >= 3 && string(argv[1]) == "--generate") {
+        int count, seed = 1;
+        string outDir = ".";
+        bool valid = validateNumericInput(argv[2], count, 1000, 10000000);
+        for (int i = 3; valid && i < argc; i += 2) {
+            string option = argv[i];
+            if (i + 1 < argc && option == "--seed") {
+                valid = validateNumericInput(argv[i + 1], seed, 0, INT_MAX);
+            } else if (i + 1 < argc && option == "--out") {
+                outDir = argv[i + 1];
+            } else {
+                valid = false;
+            }
+        }
+        if (!valid) {
+            cerr << "Usage: --generate <1000-10000000> [--seed n] [--out dir]\n";
+            return 1;
+        }
+        try {
+            SyntheticBookGenerator(count, seed, outDir).run(cout);
+        } catch (const ReservationException& ex) {
+            cerr << "Error: " << ex.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    if (argc >= 2 && string(argv[1]) == "--simulate") {
+        int days = 365, seed = 1;
+        int first = 2;
+        bool valid = true;
+        if (argc > 2 && string(argv[2]) != "--seed") {
+            valid = validateNumericInput(argv[2], days, 1, 3650);
+            first = 3;
+        }
+        if (valid && argc == first + 2 && string(argv[first]) == "--seed") {
+            valid = validateNumericInput(argv[first + 1], seed, 0, INT_MAX);
+        } else if (argc != first) {
+            valid = false;
+        }
+        if (!valid) {
+            cerr << "Usage: --simulate [1-3650 days] [--seed n]\n";
+            return 1;
+        }
+        return DemandSimulator(days, seed).run(cout) ? 0 : 1;
+    }
+    if (argc >= 3 && string(argv[1]) == "--replay") {
+        double speed = 1.0;
+        bool valid = argc == 3;
+        if (argc == 5 && string(argv[3]) == "--speed") {
+            char* end;
+            speed = string(argv[4]) == "max" ? 0.0 : strtod(argv[4], &end);
+            valid = string(argv[4]) == "max" || (*end == '\0' && speed > 0);
+        }
+        if (!valid) {
+            cerr << "Usage: --replay <trace> [--speed <factor>|max]\n";
+            return 1;
+        }
+        vector<TrafficCapture::Record> records;
+        string error;
+        if (!TrafficCapture::load(argv[2], records, error)) {
+            cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        return TrafficReplay(std::move(records), speed).run(cout) ? 0 : 1;
+    }
+
+    // --serve <port>       serve sessions over TCP instead of the console
+    // --replicate <socket> stream the mutation journal to standbys on this Unix socket
+    // --standby <socket>   follow the primary on this socket (read-only, needs --serve)
+    // --read-replicas <n>  answer listings and searches from n replica workers (needs --serve)
+    // --http <port>        serve the JSON API on this port (alongside --serve, or on its own)
+    // --http-workers <n>   HTTP worker threads (default 4)
+    // --client-rate <n>    HTTP requests per second allowed per client, 0 for no limit (default 20)
+    // --trace <n>          write one request in every n to traces.jsonl
+    // --lock-profile       record wait and hold times for every shard and journal lock site
+    // --capture <file>     record every booking and query call for --replay
+    // --remind-hours <n>   text a reminder n hours before each reservation, 0 for none (default 24)
+    // --no-show-grace <m>  release a booking m minutes past its time unless checked in, 0 for never (default 15)
+    // --clock <spec>       "real" for the system clock, or "YYYY-MM-DD HH:MM" to fix it (default 2025-05-22 22:19)
+    string servePort, replicatePath, standbyPath, httpPort, capturePath, clockSpec;
+    int replicaCount = 0, httpWorkers = 4, clientRate = 20, traceEvery = 0, remindHours = 24;
+    for (int i = 1; i < argc; ++i) {
+        string option = argv[i];
+        if (i + 1 < argc && option == "--serve") {
+            servePort = argv[++i];
+        } else if (i + 1 < argc && option == "--replicate") {
+            replicatePath = argv[++i];
+        } else if (i + 1 < argc && option == "--standby") {
+            standbyPath = argv[++i];
+        } else if (i + 1 < argc && option == "--read-replicas" && validateNumericInput(argv[i + 1], replicaCount, 1, 64)) {
+            ++i;
+        } else if (i + 1 < argc && option == "--http") {
+            httpPort = argv[++i];
+        } else if (i + 1 < argc && option == "--http-workers" && validateNumericInput(argv[i + 1], httpWorkers, 1, 256)) {
+            ++i;
+        } else if (i + 1 < argc && option == "--client-rate" && validateNumericInput(argv[i + 1], clientRate, 0, 1000000)) {
+            ++i;
+        } else if (i + 1 < argc && option == "--trace" && validateNumericInput(argv[i + 1], traceEvery, 1, 1000000)) {
+            ++i;
+        } else if (option == "--lock-profile") {
+            LockProfiler::enable();
+        } else if (i + 1 < argc && option == "--capture") {
+            capturePath = argv[++i];
+        } else if (i + 1 < argc && option == "--remind-hours" && validateNumericInput(argv[i + 1], remindHours, 0, 168)) {
+            ++i;
+        } else if (i + 1 < argc && option == "--no-show-grace"
+                   && validateNumericInput(argv[i + 1], ReservationTimers::noShowGraceMinutes, 0, 240)) {
+            ++i;
+        } else if (i + 1 < argc && option == "--clock") {
+            clockSpec = argv[++i];
+        } else {
+            cerr << "Unknown option: " << option << "\n";
+            return 1;
+        }
+    }
+    if (!standbyPath.empty() && (servePort.empty() || !replicatePath.empty())) {
+        cerr << "Error: --standby needs --serve and cannot be combined with --replicate.\n";
+        return 1;
+    }
+    if (replicaCount > 0 && (servePort.empty() || !standbyPath.empty())) {
+        cerr << "Error: --read-replicas needs --serve and cannot be used on a standby.\n";
+        return 1;
+    }
+    if (!httpPort.empty() && !standbyPath.empty()) {
+        cerr << "Error: --http cannot be used on a standby.\n";
+        return 1;
+    }
+
+    int64_t fixedMinutes;
+    if (clockSpec == "real") {
+        Clock::install(unique_ptr<Clock>(new RealClock()));
+    } else if (Clock::parseInstant(clockSpec, fixedMinutes)) {
+        Clock::install(unique_ptr<Clock>(new FixedClock(fixedMinutes)));
+    } else if (!clockSpec.empty()) {
+        cerr << "Error: --clock takes \"real\" or \"YYYY-MM-DD HH:MM\".\n";
+        return 1;
+    }
+
+    ReservationTimers::remindMinutesBefore = remindHours * 60;
+
+    if (traceEvery > 0 && !Tracer::enable(traceEvery)) {
+        return 1;
+    }
+    if (!capturePath.empty() && !TrafficCapture::enable(capturePath)) {
+        return 1;
+    }
+
+    Instrumentation::registerSection("memory", MemoryAccounting::report);
+    MemoryAccounting::registerSource("accounts", "customers", [] {
+        return MemoryAccounting::Footprint{heapBytes(customerAccounts), customerAccounts.size()};
+    });
+    MemoryAccounting::registerSource("accounts", "receptionists", [] {
+        return MemoryAccounting::Footprint{heapBytes(receptionistAccounts), receptionistAccounts.size()};
+    });
+    MemoryAccounting::registerSource("session_table", "coroutine_frames", [] {
+        return MemoryAccounting::Footprint{TaskPromiseBase::frameBytes, TaskPromiseBase::frames};
+    });
+
+    loadCustomerAccounts(customerAccounts);
+
+    unique_ptr<ReplicationFollower> follower;
+    if (!standbyPath.empty()) {
+        VenueRegistry::startAsStandby();
+        follower.reset(new ReplicationFollower());
+        if (!follower->connectAndCatchUp(standbyPath)) {
+            return 1;
+        }
+    }
+
+    unique_ptr<ReplicationPublisher> publisher;
+    if (!replicatePath.empty()) {
+        VenueRegistry& registry = VenueRegistry::getInstance();
+        publisher.reset(new ReplicationPublisher(replicatePath));
+        if (!publisher->start(registry.snapshotLines())) {
+            return 1;
+        }
+        registry.addMutationListener([&publisher](const MutationRecord& record) {
+            publisher->publish(record);
+        });
+    }
+
+    unique_ptr<ReadReplicaPool> readReplicas;
+    if (replicaCount > 0) {
+        readReplicas.reset(new ReadReplicaPool(replicaCount));
+        VenueRegistry::getInstance().addMutationListener([&readReplicas](const MutationRecord& record) {
+            readReplicas->publish(record);
+        });
+    }
+
+    VenueRegistry::getInstance().startTimers();
+
+    AdmissionController::Limits admissionLimits;
+    admissionLimits.clientRate = clientRate;
+    admissionLimits.clientBurst = clientRate * 2;
+    HttpServer httpServer(admissionLimits);
+    if (!httpPort.empty()) {
+        int port;
+        if (!validateNumericInput(httpPort, port, 1, 65535) || !httpServer.start(port, httpWorkers)) {
+            return 1;
+        }
+        cout << "Serving the HTTP API on 127.0.0.1:" << httpPort << " (" << httpWorkers << " workers)" << endl;
+        if (servePort.empty()) {
+            httpServer.wait();
+            return 0;
+        }
+    }
+
+    if (!servePort.empty()) {
+        SessionServer server;
+        int port;
+        if (!validateNumericInput(servePort, port, 1, 65535) || !server.listen(port)) {
+            return 1;
+        }
+        if (readReplicas) {
+            server.useReadReplicas(readReplicas.get());
+        }
+        if (follower) {
+            server.watch(follower->getFd(), [&follower] { return follower->readAvailable(); });
+        }
+        cout << "Serving sessions on 127.0.0.1:" << servePort << (follower ? " (read-only standby)" : "") << endl;
+        server.run();
+        return 0;
+    }
+
+    TerminalWriter::install();
+    MemoryAccounting::registerSource("log_buffers", "terminal", [] {
+        return MemoryAccounting::Footprint{TerminalWriter::getBufferSize(), 1};
+    });
+    return runConsoleSession() ? 0 : 1;
 }